@@ -0,0 +1,119 @@
+// DescriptorBenchmark.cpp : Times rewriting a set through pool allocated sets, update templates and push descriptors on a headless device.
+//
+
+#include <iostream>
+#include <string>
+#define VMA_IMPLEMENTATION
+#include <spdlog/spdlog.h>
+#include <VulkanToolbox.hpp>
+#include <spdlog/stopwatch.h>
+
+constexpr uint32_t BindingCount = 8;
+
+int main(int argc, char** argv)
+{
+	uint64_t iterations = 10000;
+	if (argc > 1)
+	{
+		iterations = std::stoull(argv[1]);
+	}
+
+	vkt::ObjectManager vom({}, false, true);
+	vkt::HeadlessOptions options;
+	options.appName = "DescriptorBenchmark";
+	if (!vkt::BootstrapHeadless(vom, options))
+	{
+		spdlog::error("No suitable device was found");
+		return 1;
+	}
+
+	//Every binding flips between two ranges so each path really has to write every descriptor on each iteration
+	std::array<vk::Buffer, BindingCount> buffers;
+	std::array<uint64_t, BindingCount> offsets = {};
+	std::array<uint64_t, BindingCount> ranges;
+	auto srcVersion = std::make_shared<uint64_t>(0);
+	for (uint32_t i = 0; i < BindingCount; i++)
+	{
+		buffers[i] = vom.VmaMakeBuffer(vk::BufferCreateInfo({}, 1024, vk::BufferUsageFlagBits::eStorageBuffer), VmaAllocationCreateInfo{ {}, VMA_MEMORY_USAGE_GPU_ONLY }).buffer;
+		ranges[i] = 256;
+	}
+	auto flipRanges = [&]()
+	{
+		for (auto& range : ranges)
+		{
+			range = range == 256 ? 512 : 256;
+		}
+		(*srcVersion)++;
+	};
+
+	vkt::DescriptorManager descriptorManager(vom);
+	auto setData = descriptorManager.GetNewSet();
+	for (uint32_t i = 0; i < BindingCount; i++)
+	{
+		setData->AddDescriptor(vk::DescriptorType::eStorageBuffer, srcVersion, vk::ShaderStageFlagBits::eCompute, &buffers[i], &offsets[i], &ranges[i]);
+	}
+	auto res = descriptorManager.Update();
+
+	//Pool allocated sets, only the bindings whose range moved are written with vkUpdateDescriptorSets
+	spdlog::stopwatch setWatch;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		flipRanges();
+		res = descriptorManager.Update();
+	}
+	double setTime = setWatch.elapsed().count();
+
+	//One vkUpdateDescriptorSetWithTemplate call per iteration for the whole set
+	vkt::DescriptorUpdateTemplate updateTemplate(vom, setData);
+	spdlog::stopwatch templateWatch;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		flipRanges();
+		updateTemplate.Update();
+	}
+	double templateTime = templateWatch.elapsed().count();
+
+	spdlog::info("Iterations: {}, bindings per set: {}", iterations, BindingCount);
+	spdlog::info("Set writes:       {:.1f} ns per set", setTime * 1e9 / iterations);
+	spdlog::info("Update templates: {:.1f} ns per set", templateTime * 1e9 / iterations);
+
+	vkt::PushDescriptorSet pushSet(vom, setData);
+	if (!pushSet.Available())
+	{
+		spdlog::warn("VK_KHR_push_descriptor is not enabled, the push descriptor paths are skipped");
+		vom.GetDevice().waitIdle();
+		return 0;
+	}
+	auto pushLayout = pushSet.GetLayout();
+	auto pipelineLayout = vom.MakePipelineLayout(vk::PipelineLayoutCreateInfo({}, 1, &pushLayout));
+	auto pool = vom.MakeCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, vom.GetComputeQueue().index));
+	auto cmd = vom.MakeCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1))[0];
+
+	//Push descriptors are recorded into the command buffer, nothing is submitted so only the recording cost is measured
+	cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	spdlog::stopwatch pushWatch;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		flipRanges();
+		pushSet.Push(cmd, vk::PipelineBindPoint::eCompute, pipelineLayout);
+	}
+	double pushTime = pushWatch.elapsed().count();
+	cmd.end();
+	cmd.reset();
+
+	pushSet.PrepareTemplate(vk::PipelineBindPoint::eCompute, pipelineLayout);
+	cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+	spdlog::stopwatch pushTemplateWatch;
+	for (uint64_t i = 0; i < iterations; i++)
+	{
+		flipRanges();
+		pushSet.Push(cmd);
+	}
+	double pushTemplateTime = pushTemplateWatch.elapsed().count();
+	cmd.end();
+
+	spdlog::info("Push writes:      {:.1f} ns per set", pushTime * 1e9 / iterations);
+	spdlog::info("Push templates:   {:.1f} ns per set", pushTemplateTime * 1e9 / iterations);
+	vom.GetDevice().waitIdle();
+	return 0;
+}
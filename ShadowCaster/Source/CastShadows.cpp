@@ -464,6 +464,7 @@ int main()
 	int objectCount = 10000000;
 	int staticCount = 100;
 	float maxDimension = 1000;
+	bool collectStatistics = true;
 #else
 	int objectCount = 0;
 	int staticCount = 0;
@@ -474,6 +475,9 @@ int main()
 	std::cin >> staticCount;
 	spdlog::info("Please Enter domain size");
 	std::cin >> maxDimension;
+	bool collectStatistics = false;
+	spdlog::info("Collect pipeline statistics (0/1)");
+	std::cin >> collectStatistics;
 #endif
 
 	vkt::ObjectManager vom({}, false, true);
@@ -509,15 +513,17 @@ int main()
 		bootDevice.surface = window.surface;
 
 		vkb::PhysicalDeviceSelector physicalDeviceSelector(bootInstance);
+		//Pipeline statistics are optional, they are only enabled below when the selected device supports them
 		VkPhysicalDeviceFeatures features{}; features.samplerAnisotropy = VK_TRUE;
 		VkPhysicalDeviceVulkan11Features features11{};
 		VkPhysicalDeviceVulkan12Features features12{}; features12.timelineSemaphore = VK_TRUE; 
-		VkPhysicalDeviceVulkan13Features features13{}; features13.dynamicRendering = VK_TRUE;
+		VkPhysicalDeviceVulkan13Features features13{}; features13.dynamicRendering = VK_TRUE; features13.synchronization2 = VK_TRUE;
 
 		auto pDeviceRet = physicalDeviceSelector
 		.set_surface(window.surface)
 		.add_required_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
 		.add_required_extension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)
+		.add_desired_extension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)
 		.set_required_features(features)
 		.set_required_features_11(features11)
 		.set_required_features_12(features12)
@@ -532,6 +538,12 @@ int main()
 			throw std::logic_error(" ");
 		}
 		bootPDevice = pDeviceRet.value();
+		if (collectStatistics && !vk::PhysicalDevice(bootPDevice.physical_device).getFeatures().pipelineStatisticsQuery)
+		{
+			spdlog::warn("pipelineStatisticsQuery is not supported by the device, pipeline statistics are turned off");
+			collectStatistics = false;
+		}
+		bootPDevice.features.pipelineStatisticsQuery = collectStatistics;
 
 		vkb::DeviceBuilder deviceBuilder{ bootPDevice };
 		auto lDeviceRet = deviceBuilder.build();
@@ -582,11 +594,14 @@ int main()
 		vk::PushConstantRange countRange(vk::ShaderStageFlagBits::eCompute, 0, sizeof(CountData));
 		CountData countData{ objectCount, staticCount, maxDimension };
 		countData.vertexCount = objectData.vertices.size();
+		vom.SetPipelineCache(std::make_shared<vkt::PersistentPipelineCache>(vom, "PipelineCache.bin"));
+		vom.SetObjectCache(std::make_shared<vkt::ObjectCache>(vom));
 		vkt::ObjectManager pVom(vom);
 		pVom.SetSurface(vom.GetSurface());
 		pVom.SetPhysicalDevice(vom.GetPhysicalDevice());
 		pVom.SetAllocator(vom.GetAllocator());
 		pVom.SetGraphicsQueue(vom.GetGraphicsQueue());
+		pVom.SetShaderCache(std::make_shared<vkt::ShaderCache>(vom));
 		vkt::VmaImage depthImage;
 		vkt::VmaImage depthImageCopy;
 		vk::Sampler depthImageSampler;
@@ -595,13 +610,19 @@ int main()
 		vk::PipelineLayout gPipelineLayout;
 		vkt::RenderPassManager renderpassManager(vom.GetDevice());
 		std::shared_ptr<uint64_t> resizeCount = std::make_shared<uint64_t>(0);
+		//The timeline of the frames that use the presentation data, old presentation data is retired on it instead of stalling
+		vk::Semaphore presentationTimeline;
+		std::shared_ptr<uint64_t> presentationSubmitCount;
 		vkt::DescriptorManager descriptorManager(vom);
 		auto stateUpdateSet = descriptorManager.GetNewSet();
 		auto graphicsSet = descriptorManager.GetNewSet();
 
 
 
-		auto BuildPresentationData = [&pVom, &depthImage, &depthImageCopy, &resizeCount](GLFWwindow* window,int,int)
+		//The depth image transitions are submitted together without stalling the resize, later frames on the graphics queue are ordered after them
+		//It lives on vom since pVom is emptied on every resize
+		vkt::ImmediateSubmitContext presentationSetup(vom);
+		auto BuildPresentationData = [&pVom, &presentationSetup, &depthImage, &depthImageCopy, &resizeCount, &presentationTimeline, &presentationSubmitCount](GLFWwindow* window,int,int)
 		{
 			if (!glfwGetWindowAttrib(window, GLFW_ICONIFIED))
 			{
@@ -609,12 +630,20 @@ int main()
 				vkb::SwapchainBuilder swapchainBuilder(pVom.GetPhysicalDevice(), pVom.GetDevice(), pVom.GetSurface());
 				auto ret = swapchainBuilder.set_old_swapchain(pVom.GetSwapchainData(true).GetSwapchain()).build();
 				spdlog::info("Shaw chain builder chose format: {}", ret->image_format);
-				pVom.DestroyAll();
+				if (presentationTimeline)
+				{
+					pVom.RetireAll(presentationTimeline, *presentationSubmitCount);
+				}
+				else
+				{
+					pVom.DestroyAll();
+				}
 				assert(ret);
 				pVom.SetSwapchain(ret->swapchain, static_cast<vk::Format>(ret->image_format), ret->extent, true);
 				auto gQueue = pVom.GetGraphicsQueue();
 				vk::Format depthFormat = vk::Format::eD32Sfloat;
 				depthImage = pVom.VmaMakeImage(
+					presentationSetup,
 					vk::ImageCreateInfo(
 						{},
 						vk::ImageType::e2D,
@@ -647,7 +676,7 @@ int main()
 					VmaAllocationCreateInfo{
 						{},
 						VMA_MEMORY_USAGE_GPU_ONLY });
-				
+				presentationSetup.Flush();
 			}
 		};
 		auto BuildPresentaionDependentDescrtiptors = [&descriptorManager, &gPipelineLayoutCreateInfo, &graphicsSet](GLFWwindow* window, int, int) {descriptorManager.Update(); gPipelineLayoutCreateInfo.pSetLayouts = &graphicsSet->layout; };
@@ -770,6 +799,7 @@ int main()
 		vkt::BufferManager gpuStorage(vom, vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
 		vkt::BufferManager gpuUniformStorage(vom, vk::BufferUsageFlagBits::eUniformBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
 		vkt::BufferManager vboStorage(vom, vk::BufferUsageFlagBits::eVertexBuffer, VMA_MEMORY_USAGE_GPU_ONLY);
+		vkt::BufferManager indirectStorage(vom, vkt::IndirectArgumentUsage, VMA_MEMORY_USAGE_GPU_ONLY);
 		auto positionsSector = gpuStorage.GetSector();
 		positionsSector->neededSize = sizeof(Translation) * objectCount;
 		auto staticsSector = gpuStorage.GetSector();
@@ -780,6 +810,8 @@ int main()
 		camdataSector->neededSize = sizeof(CamData);
 		auto modelMatrixSector = gpuStorage.GetSector();
 		modelMatrixSector->neededSize = sizeof(glm::mat4) * countData.objectCount;
+		auto drawArgumentsSector = indirectStorage.GetSector();
+		drawArgumentsSector->neededSize = sizeof(vk::DrawIndirectCommand);
 
 		auto vbo = vboStorage.GetSector();
 
@@ -790,9 +822,24 @@ int main()
 			gpuStorage.Update(true);
 			vboStorage.Update(true);
 			gpuUniformStorage.Update(true);
+			indirectStorage.Update(true);
 			ops.Execute({}, true);
 		}
 
+		stateUpdateSet->AttachSector(positionsSector, vk::ShaderStageFlagBits::eCompute);
+		stateUpdateSet->AttachSector(staticsSector, vk::ShaderStageFlagBits::eCompute);
+		stateUpdateSet->AttachSector(matrixSector, vk::ShaderStageFlagBits::eCompute);
+		stateUpdateSet->AttachSector(camdataSector, vk::ShaderStageFlagBits::eCompute);
+		stateUpdateSet->AttachSector(modelMatrixSector, vk::ShaderStageFlagBits::eCompute);
+		stateUpdateSet->AttachSector(drawArgumentsSector, vk::ShaderStageFlagBits::eCompute);
+		graphicsSet->AttachSector(matrixSector, vk::ShaderStageFlagBits::eVertex);
+		graphicsSet->AttachSector(modelMatrixSector, vk::ShaderStageFlagBits::eVertex);
+		descriptorManager.Update();
+
+		//StateUpdate compiles on a worker while the statics are generated and the graphics pipeline is built
+		vkt::JobSystem jobs(vom);
+		auto stateUpdateBuild = vkt::ComputePipelineManager::BuildAsync(jobs, vom, vk::PipelineLayoutCreateInfo({}, 1, &stateUpdateSet->layout, 1, &countRange), "shaders/StateUpdate.spv");
+
 		//Random set scope
 		{
 			vkt::DescriptorManager randomGenDescPool(vom);
@@ -802,7 +849,7 @@ int main()
 
 			
 			vkt::ComputePipelineManager randomGenStage(vom, vk::PipelineLayoutCreateInfo({}, 1, &randomGenDescSet->layout, 1, &countRange), "shaders/RandomGen.spv");
-			vkt::CommandManager cmdManager(vom, vom.GetComputeQueue(), true, vk::PipelineStageFlagBits::eComputeShader);
+			vkt::CommandManager cmdManager(vom, vom.GetComputeQueue(), true, vk::PipelineStageFlagBits2::eComputeShader);
 			auto cmd = cmdManager.RecordNew();
 			cmd.begin(vk::CommandBufferBeginInfo());
 			cmd.bindPipeline(vk::PipelineBindPoint::eCompute, randomGenStage.computePipeline);
@@ -823,31 +870,38 @@ int main()
 
 		}
 
-		stateUpdateSet->AttachSector(positionsSector, vk::ShaderStageFlagBits::eCompute);
-		stateUpdateSet->AttachSector(staticsSector, vk::ShaderStageFlagBits::eCompute);
-		stateUpdateSet->AttachSector(matrixSector, vk::ShaderStageFlagBits::eCompute);
-		stateUpdateSet->AttachSector(camdataSector, vk::ShaderStageFlagBits::eCompute);
-		stateUpdateSet->AttachSector(modelMatrixSector, vk::ShaderStageFlagBits::eCompute);
-		graphicsSet->AttachSector(matrixSector, vk::ShaderStageFlagBits::eVertex);
-		graphicsSet->AttachSector(modelMatrixSector, vk::ShaderStageFlagBits::eVertex);
-		descriptorManager.Update();
-
 
 		LightData lightData{ glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(-1.0f,1.0f,1.0f), glm::vec3(1.0f,1.0f,1.0f), 1.0f, 0.1f};
 		vk::PushConstantRange lightRange(vk::ShaderStageFlagBits::eFragment, 0, sizeof(lightData));
 		gPipelineLayoutCreateInfo = vk::PipelineLayoutCreateInfo({}, 1, &graphicsSet->layout, 1, &lightRange);
 		BuildGraphicsPipeline(window.window, 0, 0);
 
-		vkt::ComputePipelineManager stateUpdate(vom, vk::PipelineLayoutCreateInfo({}, 1, &stateUpdateSet->layout, 1, &countRange), "shaders/StateUpdate.spv");
+		auto& stateUpdate = stateUpdateBuild.Get();
 
 		vkt::MemoryOperationsBuffer frameOps(vom);
+		vkt::SubmissionBatcher frameBatch;
 		uint32_t imageIndex = 0;
 		auto imgAvailable = vom.MakeSemaphore();
-		vkt::CommandManager cmdManager(vom, vom.GetGraphicsQueue(), true, vk::PipelineStageFlagBits::eAllGraphics);
+		vkt::CommandManager cmdManager(vom, vom.GetGraphicsQueue(), true, vk::PipelineStageFlagBits2::eAllGraphics);
 		cmdManager.DependsOn({ 
-			{nullptr, imgAvailable, vk::PipelineStageFlagBits::eColorAttachmentOutput }
-			,{frameOps.cmdManager.GetSubmitCountPtr(), frameOps.cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer}
+			{nullptr, imgAvailable, vk::PipelineStageFlagBits2::eColorAttachmentOutput }
+			,{frameOps.cmdManager.GetSubmitCountPtr(), frameOps.cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits2::eComputeShader}
 		});
+		presentationTimeline = cmdManager.GetMainTimelineSignal().semaphore;
+		presentationSubmitCount = cmdManager.GetSubmitCountPtr();
+		descriptorManager.ReleaseOn(presentationTimeline, presentationSubmitCount);
+		//Frames and frame transfers use the storage buffers, a relocation waits on both and retires the old buffer after them
+		for (auto storage : { &gpuStorage, &gpuUniformStorage, &vboStorage, &indirectStorage })
+		{
+			storage->UsedOn(presentationTimeline, presentationSubmitCount);
+			storage->UsedOn(frameOps.cmdManager.GetMainTimelineSignal().semaphore, frameOps.cmdManager.GetSubmitCountPtr());
+		}
+		cmdManager.EnableProfiling(pVom.GetPhysicalDevice().getProperties().limits.timestampPeriod);
+		if (collectStatistics)
+		{
+			cmdManager.EnablePipelineStatistics();
+		}
+		vkt::FrameGraph frameGraph;
 		auto fence = vom.MakeFence(true);
 		spdlog::stopwatch sw;
 		float timeSpeedFactor = 1;
@@ -864,125 +918,109 @@ int main()
 				character.Move(countData.deltaTime/timeSpeedFactor);
 				CamData camData{character.camera.GetClip(), character.camera.Project(), character.camera.View(), character.camera.PVMatrix(), character.camera.GetPosition()};
 				imageIndex = vom.GetDevice().acquireNextImageKHR(pVom.GetSwapchainData().GetSwapchain(), UINT64_MAX, imgAvailable).value;
+				pVom.CollectRetired();
 				frameOps.Clear(true);
 				frameOps.RamToSector(&camData, camdataSector, sizeof(camData));
-				frameOps.Execute();
+				frameOps.Execute(frameBatch);
 				descriptorManager.Update();
-				cmdManager.Reset();
-				auto cmd = cmdManager.RecordNew();
-				cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
-				cmd.bindPipeline(vk::PipelineBindPoint::eCompute, stateUpdate.computePipeline);
-				cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, stateUpdate.layout, 0, 1, &stateUpdateSet->set, 0, {});
-				cmd.pushConstants(stateUpdate.layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(CountData), &countData);
-				cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipeline);
-				cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gPipelineLayout, 0, 1, &graphicsSet->set, 0, {});
-				cmd.pushConstants(gPipelineLayout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(LightData), &lightData);
-				cmd.dispatch((countData.objectCount/64) + 1, 1, 1);
-				vk::MemoryBarrier stateBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead);
-				cmd.pipelineBarrier(
-					vk::PipelineStageFlagBits::eComputeShader,
-					vk::PipelineStageFlagBits::eVertexShader,
-					{},
-					1,
-					& stateBarrier,
-					0,
-					{},
-					0,
-					{});
-				
 				auto currentImage = pVom.GetSwapchainData().GetImage(imageIndex);
 
-				//Attachment setup
-				vk::ClearColorValue clearColorValue;
-				clearColorValue.setFloat32({ 0.0f, 0.0f, 0.0f });
-				vk::ClearValue colorClear(clearColorValue);
-				vk::ClearValue depthClear(vk::ClearDepthStencilValue(1, {}));
-				vk::RenderingAttachmentInfo colorAttachment(
-					currentImage.view,
-					vk::ImageLayout::eColorAttachmentOptimal,
-					{},
-					{},
-					{},
-					vk::AttachmentLoadOp::eClear,
-					vk::AttachmentStoreOp::eStore,
-					colorClear);
-				vk::RenderingAttachmentInfoKHR depthAttachment(
-					depthImage.view,
-					depthImage.layout,
-					{},
-					{},
-					{},
-					vk::AttachmentLoadOp::eClear,
-					vk::AttachmentStoreOp::eNone,
-					depthClear
-				);
-				vk::RenderingInfoKHR renderingInfo(
-					{},
-					vk::Rect2D(0, pVom.GetSwapchainData().GetExtent()),
-					1,
-					0,
-					1,
-					& colorAttachment,
-					&depthAttachment,
-					{});
-				vk::ImageMemoryBarrier colorRenderBarrier(
-					vk::AccessFlagBits::eNoneKHR,
-					vk::AccessFlagBits::eColorAttachmentWrite,
-					vk::ImageLayout::eUndefined,
-					currentImage.layout,
-					VK_QUEUE_FAMILY_IGNORED,
-					VK_QUEUE_FAMILY_IGNORED,
-					currentImage.image,
-					vk::ImageSubresourceRange(
-						vk::ImageAspectFlagBits::eColor,
-						0,
+				frameGraph.Clear();
+				auto positions = frameGraph.ImportSector(positionsSector);
+				auto statics = frameGraph.ImportSector(staticsSector);
+				auto matrices = frameGraph.ImportSector(matrixSector);
+				auto camdata = frameGraph.ImportSector(camdataSector);
+				auto modelMatrices = frameGraph.ImportSector(modelMatrixSector);
+				auto vertices = frameGraph.ImportSector(vbo);
+				auto drawArguments = frameGraph.ImportSector(drawArgumentsSector);
+				auto swapchainImage = frameGraph.ImportImage(currentImage, vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR);
+				auto depth = frameGraph.ImportImage(depthImage, depthImage.layout, depthImage.layout, vk::ImageAspectFlagBits::eDepth);
+				//The acquire semaphore is waited on at the color attachment output stage
+				frameGraph.SetInitialUsage(swapchainImage, vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eNone);
+				frameGraph.MarkOutput(swapchainImage);
+				frameGraph.UseNormalSignal(&cmdManager);
+
+				frameGraph.AddPass("StateUpdate", &cmdManager, [&](vk::CommandBuffer cmd)
+				{
+					cmd.bindPipeline(vk::PipelineBindPoint::eCompute, stateUpdate.computePipeline);
+					cmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, stateUpdate.layout, 0, 1, &stateUpdateSet->set, 0, {});
+					cmd.pushConstants(stateUpdate.layout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(CountData), &countData);
+					cmd.dispatch((countData.objectCount / 64) + 1, 1, 1);
+				})
+					.Reads(statics, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead)
+					.Reads(camdata, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eUniformRead)
+					.Reads(positions, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead)
+					.Writes(positions, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite)
+					.Writes(matrices, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite)
+					.Writes(modelMatrices, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite)
+					.Writes(drawArguments, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageWrite)
+					.CollectStatistics(countData.objectCount);
+
+				std::array<uint64_t, 5> drawDependencies = { *resizeCount, descriptorManager.GetVersion(), gpuStorage.relocationCount, vboStorage.relocationCount, indirectStorage.relocationCount };
+				uint64_t drawVersion = vkt::HashBytes(drawDependencies.data(), sizeof(drawDependencies));
+				frameGraph.AddPass("Draw", &cmdManager, [&](vk::CommandBuffer cmd)
+				{
+					//Attachment setup
+					vk::ClearColorValue clearColorValue;
+					clearColorValue.setFloat32({ 0.0f, 0.0f, 0.0f });
+					vk::ClearValue colorClear(clearColorValue);
+					vk::ClearValue depthClear(vk::ClearDepthStencilValue(1, {}));
+					vk::RenderingAttachmentInfo colorAttachment(
+						currentImage.view,
+						vk::ImageLayout::eColorAttachmentOptimal,
+						{},
+						{},
+						{},
+						vk::AttachmentLoadOp::eClear,
+						vk::AttachmentStoreOp::eStore,
+						colorClear);
+					vk::RenderingAttachmentInfoKHR depthAttachment(
+						depthImage.view,
+						depthImage.layout,
+						{},
+						{},
+						{},
+						vk::AttachmentLoadOp::eClear,
+						vk::AttachmentStoreOp::eNone,
+						depthClear
+					);
+					vk::RenderingInfoKHR renderingInfo(
+						{},
+						vk::Rect2D(0, pVom.GetSwapchainData().GetExtent()),
 						1,
 						0,
-						1));
-				cmd.pipelineBarrier(
-					vk::PipelineStageFlagBits::eTopOfPipe,
-					vk::PipelineStageFlagBits::eColorAttachmentOutput,
-					{},
-					0,
-					{},
-					0,
-					{},
-					1,
-					& colorRenderBarrier);
-
-				cmd.bindVertexBuffers(0, 1, &vbo->bufferAllocation->bufferData.buffer, &vbo->allocationOffset);
-				cmd.beginRendering(&renderingInfo);
-				cmd.draw(objectData.vertices.size(), countData.objectCount, 0, 0);
-				cmd.endRendering();
-				vk::ImageMemoryBarrier colorPresentBarrier(
-					vk::AccessFlagBits::eColorAttachmentWrite,
-					vk::AccessFlagBits::eNone,
-					vk::ImageLayout::eColorAttachmentOptimal,
-					vk::ImageLayout::ePresentSrcKHR,
-					VK_QUEUE_FAMILY_IGNORED,
-					VK_QUEUE_FAMILY_IGNORED,
-					currentImage.image,
-					vk::ImageSubresourceRange(
-						vk::ImageAspectFlagBits::eColor,
-						0,
 						1,
-						0,
-						1));
-
-				cmd.pipelineBarrier(
-					vk::PipelineStageFlagBits::eAllCommands,
-					vk::PipelineStageFlagBits::eBottomOfPipe,
-					{},
-					0,
-					{},
-					0,
-					{},
-					1,
-					& colorPresentBarrier);
-
-				cmd.end();
-
-				cmdManager.Execute(true, true, true, true);
+						& colorAttachment,
+						&depthAttachment,
+						{});
+
+					cmd.bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipeline);
+					cmd.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, gPipelineLayout, 0, 1, &graphicsSet->set, 0, {});
+					cmd.pushConstants(gPipelineLayout, vk::ShaderStageFlagBits::eFragment, 0, sizeof(LightData), &lightData);
+					cmd.bindVertexBuffers(0, 1, &vbo->bufferAllocation->bufferData.buffer, &vbo->allocationOffset);
+					cmd.beginRendering(&renderingInfo);
+					vkt::DrawIndirect(cmd, drawArgumentsSector, 1);
+					cmd.endRendering();
+				})
+					.ReadsIndirect(drawArguments)
+					.Reads(vertices, vk::PipelineStageFlagBits2::eVertexAttributeInput, vk::AccessFlagBits2::eVertexAttributeRead)
+					.Reads(matrices, vk::PipelineStageFlagBits2::eVertexShader, vk::AccessFlagBits2::eShaderStorageRead)
+					.Reads(modelMatrices, vk::PipelineStageFlagBits2::eVertexShader, vk::AccessFlagBits2::eShaderStorageRead)
+					.Writes(swapchainImage, vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentWrite, vk::ImageLayout::eColorAttachmentOptimal)
+					.Writes(depth, vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests, vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite, depthImage.layout)
+					//The draw captures the swapchain, the graphics set and the sectors it reads, it is recorded again once any of them changed
+					.Cached(imageIndex, drawVersion)
+					.CollectStatistics(countData.objectCount);
+
+				if (!frameGraph.Compile())
+				{
+					std::cout << "ERROR: The frame graph's command managers depend on each other in a cycle" << std::endl;
+					throw std::logic_error(" ");
+				}
+				frameGraph.Execute(frameBatch);
+				frameBatch.Flush();
+				cmdManager.Wait();
+				std::lock_guard<std::mutex> presentLock(vkt::QueueMutex(vom.GetGraphicsQueue().queue));
 				auto res = vom.GetGraphicsQueue().queue.presentKHR(vk::PresentInfoKHR(1, &cmdManager.GetMainSignal().semaphore, 1, &pVom.GetSwapchainData().swapchain, &imageIndex));
 
 			}
@@ -993,6 +1031,15 @@ int main()
 			if (accumulatedTime > 1)
 			{
 				spdlog::info("Frame Delta Time: {} FPS: {:.3f}", countData.deltaTime, 1 / countData.deltaTime);
+				for (auto& zone : cmdManager.GetZoneStatistics())
+				{
+					spdlog::info("GPU {}: {:.3f} ms (avg {:.3f}, min {:.3f}, max {:.3f})", zone.name, zone.lastMs, zone.averageMs, zone.minMs, zone.maxMs);
+				}
+				for (auto& report : cmdManager.GetPipelineStatistics())
+				{
+					spdlog::info("{} per object: {:.2f} compute ({} excess) {:.2f} vertex {:.2f} clipped {:.2f} fragment invocations",
+						report.name, report.computeInvocationsPerObject, report.excessComputeInvocations, report.vertexInvocationsPerObject, report.clippingPrimitivesPerObject, report.fragmentInvocationsPerObject);
+				}
 
 				accumulatedTime = 0;
 			}
@@ -0,0 +1,123 @@
+// SubmitAllocations.cpp : Checks that submitting through a command manager, a batcher or a submission thread does not allocate once its storage has warmed up.
+//
+
+#include <iostream>
+#include <new>
+#include <cstdlib>
+#define VMA_IMPLEMENTATION
+#include <spdlog/spdlog.h>
+#include <VulkanToolbox.hpp>
+
+static std::atomic<uint64_t> allocationCount = 0;
+
+void* operator new(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* memory = std::malloc(size == 0 ? 1 : size);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+void operator delete[](void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+constexpr int SkipCode = 77;
+constexpr uint64_t WarmupFrames = 8;
+constexpr uint64_t MeasuredFrames = 256;
+
+int main()
+{
+	vkt::ObjectManager vom({}, false, true);
+	if (!vkt::BootstrapHeadless(vom))
+	{
+		spdlog::warn("No suitable device was found, skipping");
+		return SkipCode;
+	}
+
+	//The consumer waits on the producer so both the wait and the signal infos are filled every frame
+	vkt::CommandManager producer(vom, vom.GetGeneralQueue(), true, vk::PipelineStageFlagBits2::eAllCommands);
+	vkt::CommandManager consumer(vom, vom.GetGeneralQueue(), true, vk::PipelineStageFlagBits2::eAllCommands);
+	consumer.DependsOn(std::vector<vkt::CommandManager*>{ &producer });
+	vkt::SubmissionBatcher batcher;
+
+	auto record = [](vkt::CommandManager& manager)
+	{
+		auto cmd = manager.RecordNew();
+		cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+		cmd.end();
+	};
+	auto measure = [&](const char* path, auto&& submit)
+	{
+		auto frame = [&]()
+		{
+			record(producer);
+			record(consumer);
+			submit();
+			consumer.Wait();
+			producer.Reset();
+			consumer.Reset();
+		};
+		for (uint64_t i = 0; i < WarmupFrames; i++)
+		{
+			frame();
+		}
+		uint64_t before = allocationCount.load(std::memory_order_relaxed);
+		for (uint64_t i = 0; i < MeasuredFrames; i++)
+		{
+			frame();
+		}
+		uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - before;
+		if (allocations != 0)
+		{
+			spdlog::error("{}: {} allocations over {} frames", path, allocations, MeasuredFrames);
+			return 1;
+		}
+		spdlog::info("{}: no allocations over {} frames", path, MeasuredFrames);
+		return 0;
+	};
+
+	int failures = 0;
+	failures += measure("Execute", [&]()
+	{
+		producer.Execute(true, false, false);
+		consumer.Execute(true, true, false);
+	});
+	failures += measure("SubmissionBatcher", [&]()
+	{
+		producer.Execute(batcher, true, false);
+		consumer.Execute(batcher, true, false);
+		batcher.Flush();
+	});
+	{
+		//Once a submission thread exists every submission to its queue has to go through it, so it only lives for this path
+		vkt::SubmissionThread thread(vom, vom.GetGeneralQueue());
+		failures += measure("SubmissionThread", [&]()
+		{
+			producer.Execute(thread, true, false);
+			consumer.Execute(thread, true, false);
+			thread.Flush();
+		});
+	}
+	vom.GetDevice().waitIdle();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief Hands out indices below a capacity, freed indices are handed out again before new ones
+	 */
+	class DescriptorIndexAllocator
+	{
+	public:
+		DescriptorIndexAllocator(uint32_t _capacity = 0);
+
+		/**
+		 * \return UINT32_MAX when every index is in use
+		 */
+		uint32_t Allocate();
+		void Free(uint32_t index);
+		uint32_t Capacity();
+		uint32_t InUse();
+
+	private:
+		uint32_t capacity;
+		uint32_t next = 0;
+		std::vector<uint32_t> freeIndices;
+	};
+
+	struct BindlessLimits
+	{
+		uint32_t storageBuffers = 65536;
+		uint32_t sampledImages = 65536;
+		uint32_t samplers = 1024;
+	};
+
+	struct PendingBindlessWrite
+	{
+		uint32_t binding;
+		uint32_t index;
+		vk::DescriptorBufferInfo bInfo;
+		vk::DescriptorImageInfo iInfo;
+	};
+
+	struct PendingBindlessFree
+	{
+		uint32_t binding;
+		uint32_t index;
+		vk::Semaphore semaphore;
+		uint64_t value = 0;
+	};
+
+	struct BindlessSector
+	{
+		std::shared_ptr<SectorData> sector;
+		std::shared_ptr<uint64_t> srcVersion;
+		vk::DescriptorBufferInfo bInfo;
+		uint32_t index;
+	};
+
+	/**
+	 * \brief The sectors of one buffer manager, they only need to be looked at once its submit count moved
+	 */
+	struct BindlessSectorGroup
+	{
+		std::shared_ptr<uint64_t> srcVersion;
+		uint64_t version = UINT64_MAX;
+		std::vector<SectorData*> sectors;
+	};
+
+	/**
+	 * \brief One update after bind, partially bound set that holds every storage buffer, sampled image and sampler under a stable index
+	 * Shaders index the arrays at StorageBufferBinding, SampledImageBinding and SamplerBinding directly, so the set is bound once per pipeline layout no matter how many resources exist
+	 * Descriptors are only written by Update, so an index handed out can be pushed to shaders right away and written before the submission that uses it
+	 * A written index is never rewritten while it may be in use, moved sectors get a new index and the old one is freed through the ReleaseOn timeline
+	 */
+	class BindlessTable
+	{
+	public:
+		static constexpr uint32_t StorageBufferBinding = 0;
+		static constexpr uint32_t SampledImageBinding = 1;
+		static constexpr uint32_t SamplerBinding = 2;
+
+		/**
+		 * \brief The limits are clamped to what the device supports for update after bind descriptors, per type and in total
+		 */
+		BindlessTable(ObjectManager& _vom, vk::ShaderStageFlags _stages = vk::ShaderStageFlagBits::eAll, BindlessLimits _limits = {});
+
+		/**
+		 * \brief Turns on the descriptor indexing features the table needs, for device creation
+		 */
+		static void RequireFeatures(VkPhysicalDeviceVulkan12Features& features12);
+		static bool Supported(vk::PhysicalDevice physicalDevice);
+
+		/**
+		 * \brief The sector has to live in a storage buffer, when its buffer manager moves it Update gives it a new index that GetSectorIndex returns
+		 */
+		uint32_t AddSector(std::shared_ptr<SectorData> sector);
+		uint32_t GetSectorIndex(const std::shared_ptr<SectorData>& sector);
+		void RemoveSector(const std::shared_ptr<SectorData>& sector, vk::Semaphore semaphore = {}, uint64_t value = 0);
+		uint32_t AddBuffer(vk::DescriptorBufferInfo bufferInfo);
+		uint32_t AddImage(vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+		uint32_t AddSampler(vk::Sampler sampler);
+
+		/**
+		 * \brief Rewrites an index in place, no submission that is still pending may use it
+		 */
+		void SetBuffer(uint32_t index, vk::DescriptorBufferInfo bufferInfo);
+		void SetImage(uint32_t index, vk::ImageView view, vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
+		/**
+		 * \brief Frees the index once the timeline semaphore reaches value, a null semaphore frees it on the next Update
+		 * The descriptor is left as it is, partially bound arrays allow stale entries as long as shaders do not access them
+		 */
+		void RemoveBuffer(uint32_t index, vk::Semaphore semaphore = {}, uint64_t value = 0);
+		void RemoveImage(uint32_t index, vk::Semaphore semaphore = {}, uint64_t value = 0);
+		void RemoveSampler(uint32_t index, vk::Semaphore semaphore = {}, uint64_t value = 0);
+
+		/**
+		 * \brief Writes new and moved descriptors with a single vkUpdateDescriptorSets call and frees the indices whose timeline values were reached
+		 */
+		void Update();
+
+		/**
+		 * \brief Indices replaced by Update are freed once the semaphore reaches the value valuePtr points at during that Update
+		 * Without a timeline they are freed right away, so the caller has to make sure no submission still uses them
+		 */
+		void ReleaseOn(vk::Semaphore semaphore, std::shared_ptr<uint64_t> valuePtr);
+		void Bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex = 0);
+
+		vk::DescriptorSet GetSet();
+		vk::DescriptorSetLayout GetLayout();
+		BindlessLimits GetLimits();
+
+	private:
+		DescriptorIndexAllocator& Allocator(uint32_t binding);
+		void Remove(uint32_t binding, uint32_t index, vk::Semaphore semaphore, uint64_t value);
+
+		ObjectManager vom;
+		BindlessLimits limits;
+		vk::DescriptorPool pool;
+		vk::DescriptorSetLayout layout;
+		vk::DescriptorSet set;
+		DescriptorIndexAllocator bufferIndices;
+		DescriptorIndexAllocator imageIndices;
+		DescriptorIndexAllocator samplerIndices;
+		std::unordered_map<SectorData*, BindlessSector> sectors;
+		std::vector<BindlessSectorGroup> sectorGroups;
+		vk::Semaphore releaseSemaphore;
+		std::shared_ptr<uint64_t> releaseValue;
+		std::vector<PendingBindlessWrite> pendingWrites;
+		std::vector<PendingBindlessFree> pendingFrees;
+		std::vector<vk::WriteDescriptorSet> writes;
+	};
+}
@@ -2,8 +2,25 @@
 
 namespace vkt
 {
+	/**
+	 * \brief A command buffer that is recorded once and reused by the submissions of a command manager until its version changes
+	 */
+	struct CachedCommandBuffer
+	{
+		uint64_t key;
+		uint64_t version;
+		bool recorded = false;
+		vk::CommandBuffer cmd;
+
+		/**
+		 * \brief The timeline value of the last submission that used the buffer, it must be reached before the buffer is re-recorded
+		 */
+		uint64_t lastSubmitValue = 0;
+	};
+
 	/**
 	 * \brief The command Manager is a system that allows the easy management of command pools and external synchronization
+	 * A command manager records and submits from one thread at a time, threads that record in parallel each need their own
 	 */
 	class CommandManager
 	{
@@ -16,19 +33,87 @@ namespace vkt
 		 * \param _targetStages 
 		 * \param startingSubmitCount 
 		 */
-		CommandManager(ObjectManager& _vom, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount = 0);
-		CommandManager(ObjectManager& _vom, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount = 0);
-		CommandManager(vk::Device deviceHandle, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount = 0);
-		CommandManager(vk::Device deviceHandle, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount = 0);
+		CommandManager(ObjectManager& _vom, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount = 0);
+		CommandManager(ObjectManager& _vom, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount = 0);
+		CommandManager(vk::Device deviceHandle, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount = 0);
+		CommandManager(vk::Device deviceHandle, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount = 0);
 
 		vk::CommandBuffer RecordNew();
-		void DependsOn(std::vector<WaitData> waits);
+
+		/**
+		 * \brief Adds a cached command buffer to the next submission, the buffer is only recorded again when the version of its key changed or it was invalidated
+		 * \param key Identifies the recording, for example the swapchain image it renders to
+		 * \param version Any change of state captured by the recording, like resized attachments or rebuilt pipelines, must change the version
+		 * \param record Records the commands, the buffer is already begun and is ended afterwards
+		 * NOTE: Cached buffers are recorded with simultaneous use and survive Reset, re-recording waits for the last submission that used the buffer
+		 */
+		vk::CommandBuffer RecordCached(uint64_t key, uint64_t version, std::function<void(vk::CommandBuffer)> record);
+		void Invalidate(uint64_t key);
+		void InvalidateAll();
+
+		/**
+		 * \brief Creates the timestamp query pool of this manager, zones recorded before this are ignored
+		 * \param timestampPeriod The timestampPeriod limit of the physical device
+		 */
+		void EnableProfiling(float timestampPeriod, uint32_t maxZones = 64, uint32_t framesInFlight = 4);
+		bool ProfilingEnabled();
+
+		/**
+		 * \brief Times the commands recorded between BeginZone and EndZone, the results show up a few submissions later in GetZoneStatistics
+		 * NOTE: The query indices change every submission, so zones must not be recorded into cached buffers
+		 */
+		void BeginZone(vk::CommandBuffer cmd, std::string name);
+		void EndZone(vk::CommandBuffer cmd);
+		std::vector<ZoneStatistics> GetZoneStatistics();
+
+		/**
+		 * \brief Creates the pipeline statistics query pool of this manager, by default it counts the invocations of every shader stage the toolbox uses and the clipped primitives
+		 */
+		void EnablePipelineStatistics(vk::QueryPipelineStatisticFlags statistics = vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations | vk::QueryPipelineStatisticFlagBits::eClippingPrimitives | vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations | vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations, uint32_t maxZones = 32, uint32_t framesInFlight = 4);
+		bool PipelineStatisticsEnabled();
+
+		/**
+		 * \brief Counts the pipeline statistics of the commands between BeginStatistics and EndStatistics, the same restrictions as for timestamp zones apply and they can not be nested
+		 * \param objectCount The amount of objects the commands process
+		 */
+		void BeginStatistics(vk::CommandBuffer cmd, std::string name, uint64_t objectCount);
+		void EndStatistics(vk::CommandBuffer cmd);
+		std::vector<PipelineStatisticsReport> GetPipelineStatistics();
+		void DependsOn(const std::vector<WaitData>& waits);
 		void DependsOn(std::vector<CommandManager*> managers);
+
+		/**
+		 * \brief Waits on already resolved timeline values, this does not allocate and is what the per frame submit paths use
+		 */
+		void DependsOn(const SemaphoreWaits& waits);
+
+		/**
+		 * \brief Waits on resolved timeline values with the next submission only, they are dropped once it was built
+		 */
+		void DependsOnNext(const SemaphoreWaits& waits);
 		void ClearDepends();
 		void AddFreeBuffers(std::vector<vk::CommandBuffer> buffers);
 
-		vk::SubmitInfo GetSubmitInfo(bool incrementSubmitCount, bool withNormalWaits = true, bool withNormalSignals = true);
+		/**
+		 * \brief Builds the synchronization2 submit info of this manager, the returned struct points into storage owned by the manager
+		 */
+		vk::SubmitInfo2 GetSubmitInfo(bool incrementSubmitCount, bool withNormalWaits = true, bool withNormalSignals = true);
 		void Execute(bool incrementSubmitCount, bool wait, bool useNormalSignal, bool withNormalWaits = true);
+
+		/**
+		 * \brief Hands this managers submission to a batcher instead of submitting it, the submission reaches the queue when the batcher is flushed
+		 * \param batcher The batcher that will collect the submission
+		 * \param incrementSubmitCount Whether to increment the timeline signal value before the values are captured
+		 * \param useNormalSignal Whether the binary signal semaphore is signaled as well
+		 * \param withNormalWaits Whether binary wait semaphores are waited on as well
+		 */
+		void Execute(SubmissionBatcher& batcher, bool incrementSubmitCount, bool useNormalSignal, bool withNormalWaits = true);
+
+		/**
+		 * \brief Hands this managers submission to the submission thread of its queue, the timeline values are captured on the calling thread
+		 * NOTE: A command manager itself must only be used by one thread at a time, the thread safety is between managers sharing a queue
+		 */
+		void Execute(SubmissionThread& thread, bool incrementSubmitCount, bool useNormalSignal, bool withNormalWaits = true);
 		bool IsFinished();
 		void Wait();
 		void Reset();
@@ -44,9 +129,17 @@ namespace vkt
 	private:
 		ObjectManager vom;
 		vk::CommandPool externalCommandPool;
+		vk::CommandPool cachedCommandPool;
+		std::vector<CachedCommandBuffer> cachedCommandBuffers;
 		std::shared_ptr<uint64_t> submitCount;
-		vk::SubmitInfo submitInfo;
+		//The semaphore infos are inline and the command buffer infos keep their capacity, so building a submission does not allocate once warmed up
+		InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores> waitInfos;
+		std::vector<vk::CommandBufferSubmitInfo> commandBufferInfos;
+		InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores> signalInfos;
+		vk::SubmitInfo2 submitInfo;
 		vk::Fence fence;
-		vk::PipelineStageFlags targetStages;
+		vk::PipelineStageFlags2 targetStages;
+		TimestampProfiler profiler;
+		PipelineStatisticsProfiler statisticsProfiler;
 	};
 }
@@ -0,0 +1,53 @@
+#pragma once
+namespace vkt
+{
+	struct CompletionCallback
+	{
+		vk::Semaphore semaphore;
+		uint64_t value;
+		std::function<void()> callback;
+	};
+
+	/**
+	 * \brief The completion service waits on many timeline semaphores at once on a worker thread and runs callbacks once their values are reached
+	 * Callbacks run on the worker thread in no particular order, they must not register new callbacks while holding locks the caller of OnComplete needs
+	 */
+	class CompletionService
+	{
+	public:
+		CompletionService(ObjectManager& _vom);
+		CompletionService(vk::Device deviceHandle);
+		~CompletionService();
+
+		/**
+		 * \brief Runs the callback on the worker once the timeline semaphore reaches value, callbacks for values that are already reached run on the next wake up
+		 */
+		void OnComplete(vk::Semaphore semaphore, uint64_t value, std::function<void()> callback);
+
+		/**
+		 * \brief Runs the callback once the latest submission of the manager finished
+		 */
+		void OnComplete(CommandManager& manager, std::function<void()> callback);
+
+		/**
+		 * \brief Stops the worker, callbacks that have not run yet are dropped
+		 */
+		void Stop();
+		uint64_t PendingCount();
+
+	private:
+		void Start();
+		void Wake();
+		void Run();
+
+		ObjectManager vom;
+		vk::Semaphore wakeSemaphore;
+		//Guards the increment and the signal together, host signals have to reach the semaphore in increasing order
+		std::mutex wakeMutex;
+		uint64_t wakeValue = 0;
+		std::mutex pendingMutex;
+		std::vector<CompletionCallback> pending;
+		std::atomic<bool> running = false;
+		std::thread worker;
+	};
+}
@@ -0,0 +1,191 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief A bounded lock-free queue that any amount of threads can push to and a single thread pops from
+	 * Every slot carries a sequence number, producers claim a slot by advancing the enqueue position and publish it through the slot's sequence
+	 * The slots are allocated once with the queue, so pushing and popping never allocate, a push into a full queue yields until the consumer made room
+	 */
+	template<typename T, size_t N>
+	class MpscQueue
+	{
+		static_assert(N >= 2 && (N & (N - 1)) == 0, "The capacity of an MpscQueue must be a power of two");
+
+	public:
+		MpscQueue()
+			: slots(std::make_unique<Slot[]>(N))
+		{
+			for (size_t i = 0; i < N; i++)
+			{
+				slots[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		/**
+		 * \brief Can be called from any thread, blocks while the queue is full
+		 */
+		void Push(T value)
+		{
+			while (!TryPush(value))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		/**
+		 * \brief Can be called from any thread, value is only moved from when there was room
+		 */
+		bool TryPush(T& value)
+		{
+			size_t position = enqueuePosition.load(std::memory_order_relaxed);
+			while (true)
+			{
+				Slot& slot = slots[position & (N - 1)];
+				size_t sequence = slot.sequence.load(std::memory_order_acquire);
+				intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+				if (difference == 0)
+				{
+					if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					{
+						slot.value = std::move(value);
+						slot.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (difference < 0)
+				{
+					//The consumer has not freed the slot of the previous lap yet
+					return false;
+				}
+				else
+				{
+					position = enqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		/**
+		 * \brief Must only be called from the consumer thread, a push that claimed its slot but did not publish it yet is seen by a later call
+		 */
+		bool TryPop(T& value)
+		{
+			Slot& slot = slots[dequeuePosition & (N - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+			{
+				return false;
+			}
+			value = std::move(slot.value);
+			//Owning types like shared pointers are released right away instead of when the slot is reused
+			slot.value = T();
+			slot.sequence.store(dequeuePosition + N, std::memory_order_release);
+			dequeuePosition++;
+			return true;
+		}
+
+		/**
+		 * \brief Must only be called from the consumer thread
+		 */
+		bool Empty()
+		{
+			return slots[dequeuePosition & (N - 1)].sequence.load(std::memory_order_acquire) != dequeuePosition + 1;
+		}
+
+		constexpr size_t capacity() const { return N; }
+
+	private:
+		struct Slot
+		{
+			std::atomic<size_t> sequence = 0;
+			T value;
+		};
+
+		std::unique_ptr<Slot[]> slots;
+		//Producers share the enqueue position, it gets its own cache line so the consumer's position is not invalidated with it
+		alignas(64) std::atomic<size_t> enqueuePosition = 0;
+		alignas(64) size_t dequeuePosition = 0;
+	};
+
+	/**
+	 * \brief A vector with a fixed capacity that lives inside its owner, it never allocates and throws std::length_error when the capacity is exceeded
+	 * The check stays in release builds since writing past the end would corrupt the owner
+	 * Only the parts of std::vector the toolbox needs are provided
+	 */
+	template<typename T, size_t N>
+	class InlineVector
+	{
+	public:
+		template<typename... Args>
+		T& emplace_back(Args&&... args)
+		{
+			Reserve(count + 1);
+			elements[count] = T(std::forward<Args>(args)...);
+			return elements[count++];
+		}
+
+		/**
+		 * \brief Replaces the elements with a copy of values
+		 */
+		void assign(std::span<const T> values)
+		{
+			Reserve(values.size());
+			clear();
+			std::copy(values.begin(), values.end(), elements.begin());
+			count = values.size();
+		}
+
+		/**
+		 * \brief Moves every element from index onwards one slot back and places value at index
+		 */
+		T& insert(size_t index, T value)
+		{
+			assert(index <= count);
+			Reserve(count + 1);
+			for (size_t i = count; i > index; i--)
+			{
+				elements[i] = std::move(elements[i - 1]);
+			}
+			elements[index] = std::move(value);
+			count++;
+			return elements[index];
+		}
+
+		/**
+		 * \brief Resets the used elements so that owning types like shared pointers are released right away
+		 */
+		void clear()
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				elements[i] = T();
+			}
+			count = 0;
+		}
+
+		size_t size() const { return count; }
+		constexpr size_t capacity() const { return N; }
+		bool empty() const { return count == 0; }
+		T* data() { return elements.data(); }
+		const T* data() const { return elements.data(); }
+		T& operator[](size_t index) { return elements[index]; }
+		const T& operator[](size_t index) const { return elements[index]; }
+		T& back() { return elements[count - 1]; }
+		T* begin() { return elements.data(); }
+		T* end() { return elements.data() + count; }
+		const T* begin() const { return elements.data(); }
+		const T* end() const { return elements.data() + count; }
+
+	private:
+		void Reserve(size_t size)
+		{
+			if (size > N)
+			{
+				throw std::length_error("InlineVector capacity exceeded");
+			}
+		}
+
+		std::array<T, N> elements{};
+		size_t count = 0;
+	};
+}
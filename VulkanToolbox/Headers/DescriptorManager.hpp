@@ -104,14 +104,37 @@ namespace vkt
 		uint32_t size();
 	};
 
+	/**
+	 * \brief The bindings of a set that share one source version, they only need to be looked at once that version moves
+	 */
+	struct DescriptorVersionGroup
+	{
+		std::shared_ptr<uint64_t> srcVersion;
+		uint64_t version = UINT64_MAX;
+		std::vector<uint32_t> bindings;
+	};
+
+	/**
+	 * \brief Every binding takes one record of this size in template data, big enough for a buffer or an image info
+	 */
+	constexpr size_t DescriptorTemplateStride = (std::max)(sizeof(vk::DescriptorBufferInfo), sizeof(vk::DescriptorImageInfo));
+
 	struct DescriptorSetData
 	{
 		SectorDescriptorData descData;
 		vk::DescriptorSet set = nullptr;
+		vk::DescriptorPool pool;
+		/**
+		 * \brief Where the set lives in the descriptor buffer when the manager uses that backend, the bindings start at their offsets from there
+		 */
+		uint64_t bufferOffset = 0;
+		uint64_t bufferSize = 0;
+		std::vector<uint64_t> bindingOffsets;
 		uint32_t layoutBindingCount = 0;
 		vk::DescriptorSetLayout layout;
 		std::vector < vk::DescriptorSetLayoutBinding > bindings;
-		std::vector<vk::WriteDescriptorSet> writes;
+		std::vector<DescriptorVersionGroup> versionGroups;
+		std::vector<uint8_t> templateData;
 		bool NeedsRewrite();
 		bool NeedsAllocation();
 		void AddDescriptor(vk::DescriptorType type, std::shared_ptr<uint64_t> srcVersion, vk::ShaderStageFlags targetStage, vk::Buffer* buffer, uint64_t* offset, uint64_t* range);
@@ -119,23 +142,215 @@ namespace vkt
 		void AttachSector(std::shared_ptr<SectorData> sector, vk::ShaderStageFlags targetStage);
 		void ProduceTypeCounts(std::vector<vk::DescriptorPoolSize>& typeCounts);
 		vk::DescriptorSetLayoutCreateInfo ProduceSetLayout();
-		std::vector<vk::WriteDescriptorSet>& Write();
+
+		/**
+		 * \brief Appends writes for the bindings whose source version moved and whose buffer or image actually changed
+		 * The writes point into descData, so they have to be used before descriptors are added to this set
+		 */
+		void Write(std::vector<vk::WriteDescriptorSet>& writes);
+
+		/**
+		 * \brief Marks every binding as unwritten, used when the set was reallocated
+		 */
+		void Invalidate();
+
+		/**
+		 * \brief One update template entry per binding, binding i reads record i of the template data
+		 */
+		void ProduceTemplateEntries(std::vector<vk::DescriptorUpdateTemplateEntry>& entries);
+
+		/**
+		 * \brief Copies the current buffer and image infos of every binding into templateData
+		 */
+		const void* GatherTemplateData();
+	};
+
+	struct DescriptorAllocation
+	{
+		vk::DescriptorSet set;
+		vk::DescriptorPool pool;
+	};
+
+	struct DescriptorPoolData
+	{
+		vk::DescriptorPool pool;
+		uint32_t maxSets = 0;
+		uint32_t allocatedSets = 0;
+	};
+
+	struct PendingDescriptorFree
+	{
+		DescriptorAllocation allocation;
+		vk::Semaphore semaphore;
+		uint64_t value = 0;
+	};
+
+	/**
+	 * \brief A chain of pools that sets are allocated from and freed to one at a time, a new and bigger pool is added when the existing ones are full
+	 * New pools are sized for every descriptor type seen so far, each set counting with the most descriptors of a type any set asked for
+	 * A pool that is only added for new or larger descriptor counts keeps the set count of the one before it
+	 */
+	class DescriptorPoolChain
+	{
+	public:
+		DescriptorPoolChain(ObjectManager& _vom, uint32_t _setsPerPool = 16);
+		DescriptorPoolChain(vk::Device deviceHandle, uint32_t _setsPerPool = 16);
+
+		/**
+		 * \param typeCounts The descriptors the layout holds per type
+		 */
+		DescriptorAllocation Allocate(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorPoolSize>& typeCounts);
+
+		/**
+		 * \brief Returns the set to its pool right away
+		 */
+		void Free(DescriptorAllocation allocation);
+
+		/**
+		 * \brief Returns the set to its pool once the timeline semaphore reaches value, so command buffers still in flight can keep using it
+		 */
+		void Free(DescriptorAllocation allocation, vk::Semaphore semaphore, uint64_t value);
+
+		/**
+		 * \brief Frees the sets whose timeline values were reached, Allocate does this as well
+		 */
+		void Collect();
+		uint64_t PoolCount();
+
+	private:
+		/**
+		 * \param grow Doubles the sets of the newest pool, otherwise the new pool only exists for new or larger descriptor counts and keeps the size
+		 */
+		void AddPool(bool grow);
+
+		ObjectManager vom;
+		uint32_t setsPerPool;
+		std::vector<vk::DescriptorPoolSize> setTypeCounts;
+		std::vector<DescriptorPoolData> pools;
+		std::vector<PendingDescriptorFree> pendingFrees;
+	};
+
+	enum class DescriptorBackend
+	{
+		/**
+		 * \brief Sets allocated from descriptor pools and written with vkUpdateDescriptorSets
+		 */
+		Sets,
+
+		/**
+		 * \brief Descriptors written as bytes into a host visible VK_EXT_descriptor_buffer, binding a set only sets its offset
+		 */
+		DescriptorBuffer
+	};
+
+	/**
+	 * \brief The VK_EXT_descriptor_buffer commands, they stay null when the extension was not enabled on the device
+	 */
+	struct DescriptorBufferFunctions
+	{
+		PFN_vkGetDescriptorSetLayoutSizeEXT getLayoutSize = nullptr;
+		PFN_vkGetDescriptorSetLayoutBindingOffsetEXT getBindingOffset = nullptr;
+		PFN_vkGetDescriptorEXT getDescriptor = nullptr;
+		PFN_vkCmdBindDescriptorBuffersEXT bindDescriptorBuffers = nullptr;
+		PFN_vkCmdSetDescriptorBufferOffsetsEXT setDescriptorBufferOffsets = nullptr;
+
+		bool Load(vk::Device device);
+		bool Available();
+	};
+
+	struct DescriptorRange
+	{
+		uint64_t offset = 0;
+		uint64_t size = 0;
+	};
+
+	struct PendingDescriptorRange
+	{
+		DescriptorRange range;
+		vk::Semaphore semaphore;
+		uint64_t value = 0;
 	};
 
 	class DescriptorManager
 	{
 	public:
-		DescriptorManager(ObjectManager& _vom);
+		/**
+		 * \param _backend DescriptorBuffer falls back to Sets unless the vom's EnabledFeatures has descriptorBuffer and bufferDeviceAddress and its allocator was made with VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT
+		 * Every buffer attached to a set then needs eShaderDeviceAddress
+		 * \param _descriptorBufferSize The bytes the descriptor buffer holds for all sets of this manager
+		 */
+		DescriptorManager(ObjectManager& _vom, DescriptorBackend _backend = DescriptorBackend::Sets, uint64_t _descriptorBufferSize = 65536);
 		DescriptorManager(vk::Device device);
 
 		std::shared_ptr<DescriptorSetData> GetNewSet();
 
-		void Update();
+		/**
+		 * \brief Sets that changed their descriptors get a new layout and set of their own, all other sets and their bindings stay untouched
+		 * The changed bindings of all sets are then written with a single vkUpdateDescriptorSets call
+		 * \return False when a set did not fit into the largest descriptor buffer the device allows, that set stays without a layout and is tried again on the next Update
+		 */
+		bool Update();
+
+		/**
+		 * \brief Replaced sets and layouts are released once the semaphore reaches the value valuePtr points at during the Update that replaced them
+		 * Without a timeline they are released right away, so the caller has to make sure no submission still uses them
+		 */
+		void ReleaseOn(vk::Semaphore semaphore, std::shared_ptr<uint64_t> valuePtr);
+
+		/**
+		 * \brief Binds the set with whichever backend the manager uses
+		 */
+		void Bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex, DescriptorSetData& setData);
+
+		DescriptorBackend GetBackend();
+
+		/**
+		 * \brief Changes whenever Update replaced or wrote a set, command buffers that bound the sets of this manager have to be recorded again then
+		 */
+		uint64_t GetVersion();
+
+		/**
+		 * \brief The flags pipelines need to use the sets of this manager, the descriptor buffer backend requires ePipelineCreateDescriptorBufferEXT
+		 */
+		vk::PipelineCreateFlags GetPipelineFlags();
 
 	private:
+		void Release(DescriptorSetData& setData);
+		bool SetupDescriptorBuffer(ObjectManager& _vom, uint64_t size);
+		void MakeDescriptorBuffer(uint64_t size);
+		bool PlaceInDescriptorBuffer(DescriptorSetData& setData);
+		/**
+		 * \brief Moves every set into a bigger descriptor buffer, the descriptor bytes do not depend on where they are so they are copied over
+		 */
+		bool GrowDescriptorBuffer(uint64_t minimumSize);
+		void WriteToDescriptorBuffer(DescriptorSetData& setData);
+		/**
+		 * \return UINT64_MAX when the range does not fit even after growing the buffer
+		 */
+		uint64_t AllocateRange(uint64_t size);
+		/**
+		 * \brief Keeps the free ranges sorted and merged, a range at the end of the used part shrinks it instead
+		 */
+		void FreeRange(DescriptorRange range);
+
 		ObjectManager vom;
-		vk::DescriptorPool mainPool;
+		DescriptorPoolChain pools;
+		vk::Semaphore releaseSemaphore;
+		std::shared_ptr<uint64_t> releaseValue;
 		std::vector<std::shared_ptr<DescriptorSetData>> sets;
+		std::vector<vk::WriteDescriptorSet> writes;
+
+		uint64_t version = 0;
+		DescriptorBackend backend = DescriptorBackend::Sets;
+		DescriptorBufferFunctions bufferFunctions;
+		vk::PhysicalDeviceDescriptorBufferPropertiesEXT bufferProperties;
+		VmaBuffer descriptorBuffer;
+		uint8_t* descriptorMap = nullptr;
+		vk::DeviceAddress descriptorAddress = 0;
+		uint64_t descriptorBufferSize = 0;
+		uint64_t descriptorBufferUsed = 0;
+		std::vector<DescriptorRange> freeRanges;
+		std::vector<PendingDescriptorRange> pendingRanges;
 
 	};
 }
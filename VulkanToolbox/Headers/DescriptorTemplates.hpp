@@ -0,0 +1,89 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief The VK_KHR_push_descriptor commands, loaded with vkGetDeviceProcAddr since the static loader does not export extension commands
+	 * They stay null when the extension was not enabled on the device
+	 */
+	struct PushDescriptorFunctions
+	{
+		PFN_vkCmdPushDescriptorSetKHR pushDescriptorSet = nullptr;
+		PFN_vkCmdPushDescriptorSetWithTemplateKHR pushDescriptorSetWithTemplate = nullptr;
+
+		bool Load(vk::Device device);
+		bool Available();
+	};
+
+	/**
+	 * \brief Writes every binding of a set with a single vkUpdateDescriptorSetWithTemplate call from the packed infos of its DescriptorSetData
+	 * The set data has to have its final bindings, for sets that changed a few bindings the per binding writes of the DescriptorManager are cheaper
+	 */
+	class DescriptorUpdateTemplate
+	{
+	public:
+		/**
+		 * \param _setData The layout of the set data is used, so it has to be allocated by a DescriptorManager first
+		 */
+		DescriptorUpdateTemplate(ObjectManager& _vom, std::shared_ptr<DescriptorSetData> _setData);
+
+		/**
+		 * \param set A set with the layout of the set data, null writes the set data's own set
+		 */
+		void Update(vk::DescriptorSet set = {});
+
+	private:
+		ObjectManager vom;
+		std::shared_ptr<DescriptorSetData> setData;
+		vk::DescriptorUpdateTemplate updateTemplate;
+	};
+
+	/**
+	 * \brief Pushes the bindings of a DescriptorSetData straight into the command buffer, there is no pool, no set and nothing to free
+	 * GetLayout has to be part of the pipeline layout, PrepareTemplate then turns every Push into one templated copy of the packed infos
+	 */
+	class PushDescriptorSet
+	{
+	public:
+		/**
+		 * \param _setData Only the descriptors are used, the set data does not need a DescriptorManager
+		 */
+		PushDescriptorSet(ObjectManager& _vom, std::shared_ptr<DescriptorSetData> _setData);
+
+		/**
+		 * \brief Whether the device has VK_KHR_push_descriptor enabled, nothing can be pushed otherwise
+		 */
+		bool Available();
+
+		/**
+		 * \brief A set layout made with the push descriptor flag for the bindings of the set data
+		 */
+		vk::DescriptorSetLayout GetLayout();
+
+		/**
+		 * \param pipelineLayout A layout that has GetLayout at setIndex
+		 */
+		void PrepareTemplate(vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex = 0);
+
+		/**
+		 * \brief Pushes the current descriptors with the template from PrepareTemplate
+		 */
+		void Push(vk::CommandBuffer cmd);
+
+		/**
+		 * \brief Pushes the current descriptors as writes, this works without a template
+		 */
+		void Push(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex = 0);
+
+	private:
+		ObjectManager vom;
+		std::shared_ptr<DescriptorSetData> setData;
+		PushDescriptorFunctions functions;
+		vk::DescriptorSetLayout layout;
+		vk::DescriptorUpdateTemplate updateTemplate;
+		vk::PipelineLayout templateLayout;
+		uint32_t templateSet = 0;
+		std::vector<vk::WriteDescriptorSet> writes;
+		std::vector<vk::DescriptorBufferInfo> bufferInfos;
+		std::vector<vk::DescriptorImageInfo> imageInfos;
+	};
+}
@@ -0,0 +1,184 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief A sector or image that passes of a frame graph can read or write
+	 */
+	struct FrameResource
+	{
+		std::shared_ptr<SectorData> sector;
+		VmaImage image;
+		bool isImage = false;
+		vk::ImageSubresourceRange subresourceRange;
+		vk::ImageLayout initialLayout = vk::ImageLayout::eUndefined;
+		vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags2 initialStages = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 initialAccess = vk::AccessFlagBits2::eNone;
+		vk::PipelineStageFlags2 finalStages = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2 finalAccess = vk::AccessFlagBits2::eNone;
+		bool output = false;
+	};
+
+	/**
+	 * \brief How a single pass touches a resource
+	 */
+	struct FrameResourceUsage
+	{
+		uint32_t resource;
+		vk::PipelineStageFlags2 stages;
+		vk::AccessFlags2 access;
+		vk::ImageLayout layout;
+		bool write;
+	};
+
+	/**
+	 * \brief A barrier the graph will insert, buffer and image handles are resolved when the graph is executed
+	 */
+	struct FrameBarrier
+	{
+		uint32_t resource;
+		vk::PipelineStageFlags2 srcStages;
+		vk::AccessFlags2 srcAccess;
+		vk::PipelineStageFlags2 dstStages;
+		vk::AccessFlags2 dstAccess;
+		vk::ImageLayout oldLayout;
+		vk::ImageLayout newLayout;
+	};
+
+	class FramePass
+	{
+	public:
+		FramePass(std::string _name, CommandManager* _manager, std::function<void(vk::CommandBuffer)> _record);
+
+		/**
+		 * \brief Declares that the pass reads a resource
+		 * \param layout The layout images need to be in for the pass, ignored for sectors
+		 */
+		FramePass& Reads(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access, vk::ImageLayout layout = vk::ImageLayout::eUndefined);
+
+		/**
+		 * \brief Declares that the pass writes a resource, a pass that also needs the previous contents must declare a read as well
+		 */
+		FramePass& Writes(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access, vk::ImageLayout layout = vk::ImageLayout::eUndefined);
+
+		/**
+		 * \brief Declares that the pass sources indirect draw or dispatch arguments from a sector, the graph makes the writes of earlier passes visible to the indirect command read
+		 */
+		FramePass& ReadsIndirect(uint32_t resource);
+
+		/**
+		 * \brief Keeps the pass alive even if nothing it writes is used
+		 */
+		FramePass& HasSideEffects();
+
+		/**
+		 * \brief Records the pass and its barriers into a cached command buffer of its manager, see CommandManager::RecordCached
+		 * NOTE: The barriers are resolved when the pass is recorded, moved sectors or recreated images must change the version
+		 */
+		FramePass& Cached(uint64_t key, uint64_t version);
+
+		/**
+		 * \brief Counts the pipeline statistics of the pass if its manager has them enabled
+		 * NOTE: Queries can not span command buffers, so a cached pass is recorded every frame while its statistics are collected
+		 */
+		FramePass& CollectStatistics(uint64_t objectCount);
+
+		std::string name;
+		CommandManager* manager;
+		std::function<void(vk::CommandBuffer)> record;
+		std::vector<FrameResourceUsage> usages;
+		bool sideEffects = false;
+		bool culled = false;
+		bool cached = false;
+		uint64_t cacheKey = 0;
+		uint64_t cacheVersion = 0;
+		bool collectStatistics = false;
+		uint64_t statisticsObjectCount = 0;
+		/**
+		 * \brief The earlier passes this pass has to run after, together with the stages of this pass that wait on them
+		 */
+		std::vector<std::pair<uint32_t, vk::PipelineStageFlags2>> dependencies;
+		std::vector<FrameBarrier> preBarriers;
+		std::vector<FrameBarrier> postBarriers;
+	};
+
+	/**
+	 * \brief The frame graph orders passes that declare their resource usage, culls passes whose results are never used and inserts the barriers between them
+	 * Passes are recorded into one command buffer per command manager, passes on different command managers are synchronized through the managers timeline signals
+	 * NOTE: Declaration order decides the order of conflicting accesses, no queue family ownership transfers are performed so resources shared across queue families need concurrent sharing
+	 */
+	class FrameGraph
+	{
+	public:
+		FrameGraph() = default;
+
+		uint32_t ImportSector(std::shared_ptr<SectorData> sector);
+
+		/**
+		 * \brief Adds an image to the graph
+		 * \param initialLayout The layout the image is in before the first pass that uses it
+		 * \param finalLayout The layout the image is transitioned to after the last pass that uses it, undefined leaves it in the layout of that pass
+		 * \param aspect The aspects the barriers of the image cover
+		 */
+		uint32_t ImportImage(VmaImage image, vk::ImageLayout initialLayout, vk::ImageLayout finalLayout, vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor);
+
+		/**
+		 * \brief Sets the stages and access that last touched a resource before the graph, for example the stage an acquire semaphore is waited on
+		 */
+		void SetInitialUsage(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access);
+
+		/**
+		 * \brief Sets the stages and access the final transition of an image makes available to, for example none before a present
+		 */
+		void SetFinalUsage(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access);
+
+		/**
+		 * \brief Marks a resource as a result of the graph, passes that do not contribute to a result or have side effects are culled
+		 */
+		void MarkOutput(uint32_t resource);
+
+		FramePass& AddPass(std::string name, CommandManager* manager, std::function<void(vk::CommandBuffer)> record);
+
+		/**
+		 * \brief Signals the binary semaphore of a manager when the graph is executed, for example to wait on it before presenting
+		 */
+		void UseNormalSignal(CommandManager* manager);
+
+		/**
+		 * \brief Culls, sorts and computes the barriers of the graph, must be called after the last pass is added
+		 * \return False when the managers depend on each other in a cycle, every manager is submitted once so such a graph can not be executed
+		 */
+		bool Compile();
+
+		/**
+		 * \brief Resets every manager the graph uses, records the living passes and hands one submission per manager to the batcher
+		 * The waits between managers are attached to these submissions only, the depends of the managers are left as they were
+		 * NOTE: The managers command pools are reset, the previous submissions of the managers must have finished
+		 * Nothing is recorded when the last Compile failed
+		 */
+		void Execute(SubmissionBatcher& batcher);
+
+		/**
+		 * \brief Removes all passes and resources
+		 */
+		void Clear();
+
+		std::vector<uint32_t> GetPassOrder();
+		std::vector<CommandManager*> GetManagerOrder();
+
+	private:
+		void CullPasses();
+		void SortPasses();
+		bool SortManagers();
+		void ComputeBarriers();
+
+		std::vector<FrameResource> resources;
+		std::deque<FramePass> passes;
+		std::vector<uint32_t> passOrder;
+		std::vector<CommandManager*> managerOrder;
+		std::vector<CommandManager*> normalSignalManagers;
+		std::vector<std::pair<CommandManager*, CommandManager*>> managerEdges;
+		std::vector<vk::PipelineStageFlags2> managerEdgeStages;
+		bool compiled = false;
+	};
+}
@@ -0,0 +1,58 @@
+#pragma once
+namespace vkt
+{
+	struct HeadlessOptions
+	{
+		const char* appName = "VulkanToolbox";
+		uint32_t apiMajor = 1;
+		uint32_t apiMinor = 3;
+		bool validation = false;
+		/**
+		 * \brief Allows cpu implementations like lavapipe when no gpu is available
+		 */
+		bool allowSoftware = true;
+		bool pipelineStatistics = false;
+		/**
+		 * \brief Requires the descriptor indexing features a BindlessTable needs
+		 */
+		bool bindless = false;
+		/**
+		 * \brief Requires VK_EXT_descriptor_buffer and buffer device addresses so a DescriptorManager can use the DescriptorBuffer backend
+		 */
+		bool descriptorBuffer = false;
+	};
+
+	/**
+	 * \brief Creates an instance, a device, its queues and an allocator without a window, surface or swapchain and mounts them on the vom, which manages them from then on
+	 * Discrete gpus are preferred, implementations with a single queue family like lavapipe get that queue for graphics, transfer and compute
+	 * \param vom Usually made with ObjectManager({}, false, true) since there is no device yet
+	 * \return Whether a suitable device was found, nothing is mounted otherwise
+	 */
+	bool BootstrapHeadless(ObjectManager& vom, HeadlessOptions options = {});
+
+	/**
+	 * \brief Color images that stand in for the swapchain when there is no surface, Acquire cycles through them like acquireNextImageKHR does
+	 * The images start in eColorAttachmentOptimal like the swapchain images of a vom, the caller makes sure an image is no longer in use before it comes around again
+	 */
+	class OffscreenTarget
+	{
+	public:
+		OffscreenTarget(ObjectManager& _vom, vk::Extent2D _extent, vk::Format _format = vk::Format::eR8G8B8A8Unorm, uint32_t imageCount = 2);
+
+		/**
+		 * \return The index of the next image
+		 */
+		uint32_t Acquire();
+		VmaImage GetImage(uint64_t index);
+		std::vector<VmaImage>& GetImages();
+		vk::Format GetFormat();
+		vk::Extent2D GetExtent();
+
+	private:
+		ObjectManager vom;
+		vk::Extent2D extent;
+		vk::Format format;
+		std::vector<VmaImage> images;
+		uint32_t nextImage = 0;
+	};
+}
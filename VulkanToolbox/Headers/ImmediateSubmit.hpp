@@ -0,0 +1,67 @@
+#pragma once
+namespace vkt
+{
+	struct InFlightCommandBuffer
+	{
+		vk::CommandBuffer cmd;
+		uint64_t value = 0;
+	};
+
+	/**
+	 * \brief Collects one-off work like the initial layout transitions of new images and submits all of it with a single submission that signals a timeline semaphore
+	 * Images made with ObjectManager::VmaMakeImage(context, ...) can be used by work submitted to the same queue after the flush, other queues wait on GetWait
+	 * Every function can be called from any thread
+	 */
+	class ImmediateSubmitContext
+	{
+	public:
+		ImmediateSubmitContext(ObjectManager& _vom, QueueData _queue);
+		/**
+		 * \brief Submits to the graphics queue of the vom
+		 */
+		ImmediateSubmitContext(ObjectManager& _vom);
+		/**
+		 * \brief Flushes what is left and waits for it, then destroys the pool and timeline, which the context owns instead of the vom
+		 */
+		~ImmediateSubmitContext();
+
+		/**
+		 * \brief Adds barriers to the next flush, all of them are recorded with one vkCmdPipelineBarrier2
+		 */
+		void Transition(const std::vector<vk::ImageMemoryBarrier2>& transitions);
+
+		/**
+		 * \brief Submits everything added since the last flush without waiting for it, nothing is submitted when nothing was added
+		 * \return The timeline value that is reached once the work finished
+		 */
+		uint64_t Flush();
+
+		/**
+		 * \brief Blocks until the latest flush finished
+		 */
+		void Wait();
+		bool Finished();
+
+		/**
+		 * \brief A wait on the latest flush, e.g. for cmdManager.DependsOn on another queue
+		 */
+		SemaphoreWait GetWait(vk::PipelineStageFlags2 stage);
+		vk::Semaphore GetTimeline();
+		uint64_t GetLastValue();
+
+	private:
+		/**
+		 * \brief Reuses a command buffer whose submission finished or allocates a new one, mutex must be held
+		 */
+		vk::CommandBuffer NextCommandBuffer();
+
+		ObjectManager vom;
+		QueueData queue;
+		vk::CommandPool commandPool;
+		vk::Semaphore timeline;
+		std::mutex mutex;
+		uint64_t submitted = 0;
+		std::vector<vk::ImageMemoryBarrier2> barriers;
+		std::vector<InFlightCommandBuffer> inFlight;
+	};
+}
@@ -0,0 +1,34 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief The usage a buffer manager needs so its sectors can hold indirect arguments that compute shaders write
+	 */
+	constexpr vk::BufferUsageFlags IndirectArgumentUsage = vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+
+	/**
+	 * \brief Dispatches with the vk::DispatchIndirectCommand stored in the sector
+	 * \param offset The offset of the command inside the sector
+	 */
+	void DispatchIndirect(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, uint64_t offset = 0);
+
+	/**
+	 * \brief Draws drawCount tightly packed vk::DrawIndirectCommands stored in the sector
+	 */
+	void DrawIndirect(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, uint32_t drawCount, uint64_t offset = 0, uint32_t stride = sizeof(vk::DrawIndirectCommand));
+	void DrawIndexedIndirect(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, uint32_t drawCount, uint64_t offset = 0, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand));
+
+	/**
+	 * \brief Draws as many vk::DrawIndirectCommands as the uint32_t in the count sector says, but at most maxDrawCount
+	 * NOTE: Requires the drawIndirectCount feature of vulkan 1.2
+	 */
+	void DrawIndirectCount(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, std::shared_ptr<SectorData> count, uint32_t maxDrawCount, uint64_t offset = 0, uint64_t countOffset = 0, uint32_t stride = sizeof(vk::DrawIndirectCommand));
+	void DrawIndexedIndirectCount(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, std::shared_ptr<SectorData> count, uint32_t maxDrawCount, uint64_t offset = 0, uint64_t countOffset = 0, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand));
+
+	/**
+	 * \brief Makes the arguments a previous pass wrote visible to the indirect commands that follow, passes of a frame graph get this barrier from FramePass::ReadsIndirect instead
+	 * \param srcStages The stages that wrote the arguments
+	 * \param srcAccess How the arguments were written
+	 */
+	void IndirectArgumentBarrier(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, vk::PipelineStageFlags2 srcStages = vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlags2 srcAccess = vk::AccessFlagBits2::eShaderStorageWrite);
+}
@@ -0,0 +1,113 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief A value of a timeline semaphore, jobs can wait for it to be reached or signal it from the host once they finished
+	 */
+	struct TimelinePoint
+	{
+		vk::Semaphore semaphore;
+		uint64_t value = 0;
+	};
+
+	/**
+	 * \brief A job of a JobSystem, it runs once all job dependencies finished and all gpu waits are reached
+	 */
+	struct Job
+	{
+		std::function<void()> work;
+		std::vector<TimelinePoint> signals;
+		//Starts at one so the job can not run while Schedule is still adding its dependencies
+		std::atomic<uint32_t> pendingCount = 1;
+		std::mutex continuationMutex;
+		std::vector<std::shared_ptr<Job>> continuations;
+		std::atomic<bool> finished = false;
+		/**
+		 * \brief Set for jobs that were still waiting when the job system stopped, their work did not run and their signals were not signaled
+		 */
+		std::atomic<bool> cancelled = false;
+	};
+	using JobHandle = std::shared_ptr<Job>;
+
+	/**
+	 * \brief A work stealing job system whose jobs can depend on other jobs and on timeline semaphore values, and signal timeline semaphores from the host when they finish
+	 * Every worker owns a queue it takes its newest job from, idle workers steal the oldest jobs of the other queues
+	 * The gpu waits on a job by waiting on one of its signals, e.g. cmdManager.DependsOn with a SemaphoreWait of that value
+	 */
+	class JobSystem
+	{
+	public:
+		/**
+		 * \param workerCount The amount of worker threads, 0 uses one less than the hardware threads
+		 */
+		JobSystem(ObjectManager& _vom, uint32_t workerCount = 0);
+		JobSystem(vk::Device deviceHandle, uint32_t workerCount = 0);
+		~JobSystem();
+
+		/**
+		 * \brief Schedules a job, it may run on any worker or on a thread that is waiting in Wait
+		 * \param dependencies Jobs that have to finish first
+		 * \param gpuWaits Timeline values that have to be reached first, they are waited on by a completion service instead of blocking a worker
+		 * \param signals Timeline values signaled with vkSignalSemaphore once the work finished, each must be higher than the current value of its semaphore
+		 */
+		JobHandle Schedule(std::function<void()> work, std::vector<JobHandle> dependencies = {}, std::vector<TimelinePoint> gpuWaits = {}, std::vector<TimelinePoint> signals = {});
+
+		/**
+		 * \brief Signals timeline values once the dependencies finished, this lets gpu work start right after a group of jobs without a cpu round trip
+		 */
+		JobHandle SignalAfter(std::vector<JobHandle> dependencies, std::vector<TimelinePoint> signals);
+
+		bool IsFinished(JobHandle job);
+
+		/**
+		 * \brief Runs other ready jobs on the calling thread until the job finished
+		 */
+		void Wait(JobHandle job);
+		void WaitAll();
+
+		/**
+		 * \brief Runs the jobs that are ready and stops the workers
+		 * Jobs still waiting on dependencies or gpu values are cancelled and count as finished, so Wait and WaitAll return
+		 */
+		void Stop();
+		uint32_t WorkerCount();
+
+		/**
+		 * \brief The timeline value the latest submission of the manager signals
+		 */
+		static TimelinePoint LatestSubmission(CommandManager& manager);
+
+	private:
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<JobHandle> jobs;
+		};
+		static constexpr uint64_t ExternalQueue = UINT64_MAX;
+
+		void Start(uint32_t workerCount);
+		void Notify();
+		void Release(const JobHandle& job, uint64_t queueIndex);
+		void Push(const JobHandle& job, uint64_t queueIndex);
+		bool TryPop(JobHandle& job, uint64_t queueIndex);
+		void RunJob(const JobHandle& job, uint64_t queueIndex);
+		/**
+		 * \brief Remembers a job that could not run right away, Stop cancels it if it never became ready
+		 */
+		void TrackWaiting(const JobHandle& job);
+		void Cancel(const JobHandle& job);
+		void WorkerLoop(uint64_t queueIndex);
+
+		ObjectManager vom;
+		CompletionService completion;
+		std::vector<std::unique_ptr<WorkerQueue>> queues;
+		std::vector<std::thread> workers;
+		std::mutex waitingMutex;
+		std::vector<JobHandle> waitingJobs;
+		size_t waitingPruneSize = 64;
+		std::atomic<uint64_t> nextQueue = 0;
+		std::atomic<uint64_t> unfinished = 0;
+		std::atomic<uint64_t> wakeCount = 0;
+		std::atomic<bool> running = false;
+	};
+}
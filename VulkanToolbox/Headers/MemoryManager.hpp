@@ -36,6 +36,14 @@ namespace vkt
 		VmaBuffer bufferData;
 		void* map;
 		uint64_t alignment;
+		/**
+		 * \brief Counts how often Update moved the sectors into a new buffer, recorded commands and descriptors that captured a sector are stale once it changes
+		 */
+		uint64_t relocationCount = 0;
+		/**
+		 * \brief Whether UsedOn registered a timeline, relocations then always submit so the retire point covers the users
+		 */
+		bool hasUsers = false;
 
 		std::vector<std::shared_ptr<SectorData>> sectors;
 
@@ -45,8 +53,19 @@ namespace vkt
 
 		std::shared_ptr<SectorData> GetSector();
 
+		/**
+		 * \brief When the sectors outgrew the buffer they are copied into a new one and the old buffer is retired on the timeline of the copy
+		 * Only the copy and earlier uses on the timelines registered with UsedOn are covered, a buffer used on other queues must register them
+		 */
 		void Update(bool wait = false);
 
+		/**
+		 * \brief Registers the timeline of a queue that reads or writes the sectors, every relocation copy waits on its latest value
+		 * So the copy sees all earlier writes on that queue and the old buffer is only retired once those uses finished as well
+		 * \param valuePtr Read when the copy is submitted, it must hold a value that was already submitted like the pointer from CommandManager::GetSubmitCountPtr
+		 */
+		void UsedOn(vk::Semaphore semaphore, std::shared_ptr<uint64_t> valuePtr);
+
 		void RemoveSector(std::shared_ptr<SectorData> sector);
 
 		void Clear();
@@ -80,7 +99,7 @@ namespace vkt
 			uint64_t& _dstVersion,
 			uint64_t& _size);
 
-		std::vector<WaitData> Record(vk::CommandBuffer cmd);
+		void Record(vk::CommandBuffer cmd, SemaphoreWaits& waits);
 		bool NeedsRecording();
 	};
 	struct ImageToSectorEntity
@@ -104,7 +123,7 @@ namespace vkt
 			vk::ImageSubresourceRange& _subresourceRange
 		);
 
-		std::vector<WaitData> Record(vk::CommandBuffer cmd);
+		void Record(vk::CommandBuffer cmd, SemaphoreWaits& waits);
 
 		bool NeedsRecording();
 
@@ -131,7 +150,7 @@ namespace vkt
 			vk::ImageSubresourceRange& _subresourceRange
 		);
 
-		std::vector<WaitData> Record(vk::CommandBuffer cmd);
+		void Record(vk::CommandBuffer cmd, SemaphoreWaits& waits);
 
 		bool NeedsRecording();
 	};
@@ -155,7 +174,7 @@ namespace vkt
 			vk::ImageCopy& _copyData,
 			vk::ImageSubresourceRange& _subresourceRange);
 
-		std::vector<WaitData> Record(vk::CommandBuffer cmd);
+		void Record(vk::CommandBuffer cmd, SemaphoreWaits& waits);
 
 		bool NeedsRecording();
 	};
@@ -204,7 +223,7 @@ namespace vkt
 
 		bool NeedsRecording();
 
-		std::vector<WaitData> Record(vk::CommandBuffer cmd);
+		void Record(vk::CommandBuffer cmd, SemaphoreWaits& waits);
 
 	};
 
@@ -304,6 +323,12 @@ namespace vkt
 	public:
 		ToRamTransferExecutor(vk::Device deviceHandle, std::shared_ptr<SectorData> _stagingBuffer, void* _dst, WaitData _wait);
 		void Execute();
+
+		/**
+		 * \brief Copies to ram on the worker of the completion service once the transfer finished instead of blocking, the operations buffer must have been executed already
+		 * \param callback Runs on the worker after the copy, dst must stay valid until then
+		 */
+		void ExecuteOnComplete(CompletionService& service, std::function<void()> callback = {});
 	private:
 		vk::Device device;
 		std::shared_ptr<SectorData> stagingBuffer;
@@ -346,6 +371,12 @@ namespace vkt
 		void Clear(bool freeInternalBuffer = true);
 
 		void Execute(std::vector<WaitData> transientWaits = {}, bool wait = false, bool useNormalSignal = false, bool useNormalWaits = false);
+		void Execute(SubmissionBatcher& batcher, std::vector<WaitData> transientWaits = {}, bool useNormalSignal = false, bool useNormalWaits = false);
+
+		/**
+		 * \brief Records the transfers if any of the sectors changed since the last recording and adds the waits the recorded copies need
+		 */
+		void RecordTransfers(SemaphoreWaits& waits);
 
 		void WaitOn();
 		~MemoryOperationsBuffer();
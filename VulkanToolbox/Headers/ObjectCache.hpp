@@ -0,0 +1,45 @@
+#pragma once
+namespace vkt
+{
+	struct ObjectKeyHash
+	{
+		size_t operator()(const std::vector<uint64_t>& key) const
+		{
+			return static_cast<size_t>(HashBytes(key.data(), key.size() * sizeof(uint64_t)));
+		}
+	};
+	using ObjectKey = std::vector<uint64_t>;
+
+	/**
+	 * \brief Shares samplers, descriptor set layouts and pipeline layouts between identical create infos, so rebuilt layouts keep their handles and stay compatible
+	 * The create infos are turned into canonical keys field by field, set layout bindings are sorted by binding so their order does not matter
+	 * Create infos with extension structures the cache does not know are not cached, the only one it knows is the binding flags of set layouts
+	 * Attach it to a vom with SetObjectCache so that the Make functions of that vom go through it, the objects belong to the cache and not to the vom
+	 */
+	class ObjectCache
+	{
+	public:
+		ObjectCache(ObjectManager& _vom);
+		ObjectCache(vk::Device deviceHandle);
+
+		/**
+		 * \return The shared object, or a null handle when the create info can not be cached
+		 */
+		vk::Sampler GetSampler(const vk::SamplerCreateInfo& createInfo);
+		vk::DescriptorSetLayout GetDescriptorSetLayout(const vk::DescriptorSetLayoutCreateInfo& createInfo);
+		vk::PipelineLayout GetPipelineLayout(const vk::PipelineLayoutCreateInfo& createInfo);
+
+		/**
+		 * \brief Destroys every cached object, nothing made from them may still be in use
+		 */
+		void Clear();
+		uint64_t Count();
+
+	private:
+		ObjectManager vom;
+		std::mutex mutex;
+		std::unordered_map<ObjectKey, vk::Sampler, ObjectKeyHash> samplers;
+		std::unordered_map<ObjectKey, vk::DescriptorSetLayout, ObjectKeyHash> setLayouts;
+		std::unordered_map<ObjectKey, vk::PipelineLayout, ObjectKeyHash> pipelineLayouts;
+	};
+}
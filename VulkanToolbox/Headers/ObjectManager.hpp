@@ -68,6 +68,21 @@ namespace vkt
 		vk::Queue queue;
 	};
 
+	/**
+	 * \brief Returns the mutex that guards submissions and presents to a queue, every vom and manager gets the same mutex for the same queue
+	 * vkQueueSubmit2 and vkQueuePresentKHR need the queue to be externally synchronized, so every submission in the toolbox holds it
+	 */
+	std::mutex& QueueMutex(vk::Queue queue);
+
+	/**
+	 * \brief The device features the toolbox checks before taking an optional path, whoever creates the device records what it enabled
+	 */
+	struct EnabledFeatures
+	{
+		bool bufferDeviceAddress = false;
+		bool descriptorBuffer = false;
+	};
+
 	/**
 	 * \brief A struct used by many managers to store the data needed to wait on either a normal or timelinesemaphore
 	 */
@@ -84,9 +99,9 @@ namespace vkt
 		vk::Semaphore waitSemaphore;
 
 		/**
-		 * \brief The stage that accompanies a waitSemaphore submission for a vk::submit
+		 * \brief The stage that accompanies a waitSemaphore submission for a vk::submit2
 		 */
-		vk::PipelineStageFlags waitStage;
+		vk::PipelineStageFlags2 waitStage;
 
 
 		/**
@@ -95,9 +110,42 @@ namespace vkt
 		 * \param _waitSemaphore Must be a valid semaphore
 		 * \param _waitStage The accompanying wait stage
 		 */
-		WaitData(std::shared_ptr<uint64_t> _waitValuePtr, vk::Semaphore _waitSemaphore, vk::PipelineStageFlags _waitStage);
+		WaitData(std::shared_ptr<uint64_t> _waitValuePtr, vk::Semaphore _waitSemaphore, vk::PipelineStageFlags2 _waitStage);
 	};
 
+	/**
+	 * \brief The most semaphores a single submission can wait on or signal, the submit path stores them inline so it never allocates
+	 */
+	constexpr size_t MaxSubmitSemaphores = 32;
+
+	/**
+	 * \brief A timeline wait whose value is already known, unlike WaitData it holds no pointer and can be copied around freely
+	 */
+	struct SemaphoreWait
+	{
+		vk::Semaphore semaphore;
+		uint64_t value = 0;
+		vk::PipelineStageFlags2 stage;
+	};
+	using SemaphoreWaits = InlineVector<SemaphoreWait, MaxSubmitSemaphores>;
+
+	/**
+	 * \brief Adds a wait to the list, a semaphore that is already in it keeps one entry with the higher value and both stages
+	 */
+	inline void MergeWait(SemaphoreWaits& waits, SemaphoreWait wait)
+	{
+		for (auto& existing : waits)
+		{
+			if (existing.semaphore == wait.semaphore)
+			{
+				existing.value = (std::max)(existing.value, wait.value);
+				existing.stage |= wait.stage;
+				return;
+			}
+		}
+		waits.emplace_back(wait);
+	}
+
 	/**
 	 * \brief A struct used by the VulkanObjectManager class to store all the data it needs to abstract a swapchain
 	 */
@@ -156,9 +204,66 @@ namespace vkt
 	};
 
 
+	/**
+	 * \brief Every kind of object a vom can manage, DestroyAll destroys them in this order
+	 */
+	enum class ObjectType : uint32_t
+	{
+		Semaphore, Fence, CommandPool, Framebuffer, RenderPass, ShaderModule, Pipeline, PipelineCache, PipelineLayout, Buffer, DeviceMemory, DescriptorPool, DescriptorUpdateTemplate, DescriptorSetLayout,
+		Sampler, QueryPool, Image, ImageView, VmaBuffer, VmaImage, VmaAllocator, Swapchain, Device, Surface, Instance, Count
+	};
+
+	/**
+	 * \brief A generational handle to an object managed by a vom, it turns invalid once the object is destroyed even if its slot gets reused
+	 */
+	struct ObjectHandle
+	{
+		uint32_t slot = UINT32_MAX;
+		uint32_t generation = 0;
+		uint32_t shard = 0;
+	};
+
+	/**
+	 * \brief A managed object with its type erased, the handle is the raw vulkan or vma handle
+	 */
+	struct ManagedObject
+	{
+		ObjectType type;
+		uint64_t handle = 0;
+		VmaAllocation allocation = nullptr;
+		uint32_t tag = 0;
+		uint32_t slot = 0;
+	};
+
+	/**
+	 * \brief The amount of independently locked parts the registry of a vom is split into
+	 */
+	constexpr uint32_t RegistryShardCount = 16;
+
+	/**
+	 * \brief One part of the registry of a vom, objects are spread over the shards by their handle so threads that create different objects rarely share a lock
+	 */
+	struct RegistryShard
+	{
+		std::mutex mutex;
+		//The managed objects are stored densely, slots map stable handles to their current index
+		std::vector<ManagedObject> objects;
+		std::vector<uint32_t> slotIndices;
+		std::vector<uint32_t> slotGenerations;
+		std::vector<uint32_t> freeSlots;
+		std::array<std::unordered_map<uint64_t, uint32_t>, static_cast<size_t>(ObjectType::Count)> slotLookup;
+	};
+
 	/**
 	 * \brief The key component of all the other managers, a system that handles the creation of other vulkan objects as well as their lifetimes in RAII style
+	 * Creating, managing, destroying and retiring objects is safe from any thread, the Set functions and the swapchain are meant to be used during setup only
 	 */
+	struct RetiredObjects;
+	class ShaderCache;
+	class PersistentPipelineCache;
+	class ImmediateSubmitContext;
+	class ObjectCache;
+
 	class ObjectManager
 	{
 	public:
@@ -233,6 +338,8 @@ namespace vkt
 		void SetGraphicsQueue(QueueData _graphicsQueue);
 		void SetComputeQueue(QueueData _computeQueue);
 		void SetGeneralQueue(QueueData _generalQueue);
+		EnabledFeatures GetEnabledFeatures();
+		void SetEnabledFeatures(EnabledFeatures _enabledFeatures);
 
 		vk::Semaphore MakeSemaphore(bool manage = true);
 		vk::Semaphore MakeTimelineSemaphore(uint64_t startingValue, bool manage = true);
@@ -240,81 +347,220 @@ namespace vkt
 		vk::CommandPool MakeCommandPool(vk::CommandPoolCreateInfo createInfo, bool manage = true);
 		std::vector<vk::CommandBuffer> MakeCommandBuffers(vk::CommandBufferAllocateInfo alocInfo);
 		vk::RenderPass MakeRenderPass(vk::RenderPassCreateInfo createInfo, bool manage = true);
+		/**
+		 * \brief A null cache falls back to the pipeline cache attached with SetPipelineCache
+		 */
 		vk::Pipeline MakePipeline(vk::PipelineCache cache, vk::GraphicsPipelineCreateInfo createInfo, bool manage = true);
 		vk::Pipeline MakePipeline(vk::PipelineCache cache, vk::ComputePipelineCreateInfo createInfo, bool manage = true);
+		vk::PipelineCache MakePipelineCache(vk::PipelineCacheCreateInfo createInfo, bool manage = true);
 		vk::PipelineLayout MakePipelineLayout(vk::PipelineLayoutCreateInfo createInfo, bool manage = true);
 		vk::Buffer MakeBuffer(vk::BufferCreateInfo createInfo, bool manage = true);
 		vk::DeviceMemory MakeMemoryAllocation(vk::MemoryAllocateInfo alocInfo, bool manage = true);
 		vk::DescriptorPool MakeDescriptorPool(vk::DescriptorPoolCreateInfo createInfo, bool manage = true);
 		vk::DescriptorSetLayout MakeDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo createInfo, bool manage = true);
+		vk::DescriptorUpdateTemplate MakeDescriptorUpdateTemplate(vk::DescriptorUpdateTemplateCreateInfo createInfo, bool manage = true);
 		std::vector<vk::DescriptorSet> MakeDescriptorSets(vk::DescriptorSetAllocateInfo allocateInfo);
 		vk::Image MakeImage(vk::ImageCreateInfo createInfo, bool manage = true);
 		vk::ImageView MakeImageView(vk::ImageViewCreateInfo createInfo, bool manage = true);
 		VmaAllocator GetAllocator();
 		VmaAllocator MakeAllocator(VmaAllocatorCreateInfo createInfo, bool mount = false, bool manage = true);
-		VmaAllocator MakeAllocator(uint32_t apiVersion, bool mount = false, bool manage = true);
-		void SetAllocator(VmaAllocator allocatorHandle);
+		VmaAllocator MakeAllocator(uint32_t apiVersion, bool mount = false, bool manage = true, VmaAllocatorCreateFlags flags = 0);
+		void SetAllocator(VmaAllocator allocatorHandle, VmaAllocatorCreateFlags flags = 0);
+		/**
+		 * \brief The flags the mounted allocator was created with
+		 */
+		VmaAllocatorCreateFlags GetAllocatorFlags();
 		VmaBuffer VmaMakeBuffer(vk::BufferCreateInfo bufferInfo, VmaAllocationCreateInfo allocationCreateInfo, bool manage = true);
 		VmaImage VmaMakeImage(vk::ImageCreateInfo imageInfo, vk::ImageViewCreateInfo viewInfo, VmaAllocationCreateInfo allocationCreateInfo, bool transition = true, bool manage = true);
+		/**
+		 * \brief Hands the initial transition to the context instead of submitting and waiting for it, the image can be used once the context was flushed
+		 */
+		VmaImage VmaMakeImage(ImmediateSubmitContext& context, vk::ImageCreateInfo imageInfo, vk::ImageViewCreateInfo viewInfo, VmaAllocationCreateInfo allocationCreateInfo, bool manage = true);
 		vk::Sampler MakeImageSampler(vk::SamplerCreateInfo createInfo, bool manage = true);
+		vk::QueryPool MakeQueryPool(vk::QueryPoolCreateInfo createInfo, bool manage = true);
 
 
-		void TransitionImages(vk::CommandBuffer cmd, std::vector<vk::ImageMemoryBarrier> imageTransitions, vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage);
-		void TransitionImages(std::vector<vk::ImageMemoryBarrier> imageTransitions, vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage);
+		void TransitionImages(vk::CommandBuffer cmd, std::vector<vk::ImageMemoryBarrier2> imageTransitions);
+		void TransitionImages(std::vector<vk::ImageMemoryBarrier2> imageTransitions);
+		void TransitionImages(ImmediateSubmitContext& context, std::vector<vk::ImageMemoryBarrier2> imageTransitions);
 
+		/**
+		 * \brief Maps the SPIR-V file and makes a module from it, with a shader cache attached the cached module is returned and manage is ignored since the cache owns it
+		 */
 		vk::ShaderModule MakeShaderModule(const char* shaderPath, bool manage = true);
+
+		/**
+		 * \brief Shares a shader cache with this vom, voms derived from it afterwards share it as well
+		 */
+		void SetShaderCache(std::shared_ptr<ShaderCache> cache);
+		std::shared_ptr<ShaderCache> GetShaderCache();
+
+		/**
+		 * \brief Shares a pipeline cache with this vom, voms derived from it afterwards share it as well
+		 */
+		void SetPipelineCache(std::shared_ptr<PersistentPipelineCache> cache);
+		std::shared_ptr<PersistentPipelineCache> GetPipelineCache();
+
+		/**
+		 * \brief Shares an object cache with this vom, voms derived from it afterwards share it as well
+		 * With a cache attached MakeImageSampler, MakeDescriptorSetLayout and MakePipelineLayout return shared objects and ignore manage
+		 */
+		void SetObjectCache(std::shared_ptr<ObjectCache> cache);
+		std::shared_ptr<ObjectCache> GetObjectCache();
 		vk::Framebuffer MakeFramebuffer(vk::FramebufferCreateInfo createInfo, bool manage = true);
 
-		void Manage(vk::Framebuffer frame);
-		void Manage(vk::ShaderModule module);
-		void Manage(vk::Semaphore semaphore);
-		void Manage(vk::Fence fence);
-		void Manage(vk::CommandPool commandPool);
-		void Manage(vk::RenderPass renderPass);
-		void Manage(vk::Pipeline pipeline);
-		void Manage(vk::PipelineLayout layout);
-		void Manage(vk::Buffer buffer);
-		void Manage(vk::DeviceMemory aloc);
-		void Manage(vk::Device device);
-		void Manage(vk::DescriptorPool pool);
-		void Manage(vk::DescriptorSetLayout layout);
-		void Manage(vk::Instance instance);
-		void Manage(vk::SurfaceKHR surface);
-		void Manage(SwapchainData swapchainData);
-		void Manage(vk::Image image);
-		void Manage(vk::ImageView imageView);
-		void Manage(VmaAllocator allocator);
-		void Manage(VmaBuffer buffer);
-		void Manage(VmaImage image);
-		void Manage(vk::Sampler sampler);
-
-		void DestroyType(vk::Framebuffer);
-		void DestroyType(vk::ShaderModule);
-		void DestroyType(vk::Semaphore);
-		void DestroyType(vk::Fence);
-		void DestroyType(vk::CommandPool);
-		void DestroyType(vk::RenderPass);
-		void DestroyType(vk::Pipeline);
-		void DestroyType(vk::PipelineLayout);
-		void DestroyType(vk::Buffer);
-		void DestroyType(vk::DeviceMemory);
-		void DestroyType(vk::Device);
-		void DestroyType(vk::DescriptorPool);
-		void DestroyType(vk::DescriptorSetLayout);
-		void DestroyType(vk::Instance);
-		void DestroyType(vk::SurfaceKHR);
-		void DestroyType(vk::SwapchainKHR);
-		void DestroyType(vk::Image);
-		void DestroyType(vk::ImageView);
-		void DestroyType(VmaAllocator);
-		void DestroyType(VmaBuffer);
-		void DestroyType(VmaImage);
-		void DestroyType(vk::Sampler);
+		/**
+		 * \brief Hands the lifetime of an object to this vom, an object that is already managed keeps its handle
+		 * \return A handle that stays valid until the object is destroyed, released or retired
+		 */
+		template<typename T>
+		ObjectHandle Manage(T object)
+		{
+			return Register(Describe(object));
+		}
 
+		/**
+		 * \brief Destroys a single managed object, objects this vom does not manage are ignored
+		 */
+		template<typename T>
+		void Destroy(T object)
+		{
+			auto described = Describe(object);
+			Destroy(Find(described.type, described.handle));
+		}
+
+		/**
+		 * \brief Destroys the object behind the handle, handles of objects that were already destroyed are ignored
+		 */
+		void Destroy(ObjectHandle handle);
+
+		/**
+		 * \brief Stops managing an object without destroying it
+		 */
+		template<typename T>
+		void Release(T object)
+		{
+			auto described = Describe(object);
+			Remove(Find(described.type, described.handle));
+		}
+
+		template<typename T>
+		bool Owns(T object)
+		{
+			auto described = Describe(object);
+			return IsValid(Find(described.type, described.handle));
+		}
+
+		template<typename T>
+		void DestroyType(T object)
+		{
+			DestroyType(Describe(object).type);
+		}
+		void DestroyType(ObjectType type);
+
+		/**
+		 * \brief Objects managed from now on get this tag, so that objects that are replaced together can be destroyed together with DestroyTag
+		 */
+		void SetTag(uint32_t tag);
+		uint32_t GetTag();
+
+		/**
+		 * \brief Changes the tag of a managed object
+		 */
+		template<typename T>
+		void Tag(T object, uint32_t tag)
+		{
+			auto described = Describe(object);
+			SetObjectTag(Find(described.type, described.handle), tag);
+		}
+
+		/**
+		 * \brief Destroys every object with the tag, in the same type order as DestroyAll
+		 */
+		void DestroyTag(uint32_t tag);
+		bool IsValid(ObjectHandle handle);
+		uint64_t ManagedCount();
 
 		void DestroyAll();
+
+		/**
+		 * \brief Hands an object to a deferred destruction queue, it is destroyed by CollectRetired once the timeline semaphore reaches value
+		 * \param semaphore A timeline semaphore that is signaled after the last use of the object, like the main timeline signal of a command manager
+		 */
+		template<typename T>
+		void Retire(T object, vk::Semaphore semaphore, uint64_t value)
+		{
+			CollectRetired();
+			auto described = Describe(object);
+			Remove(Find(described.type, described.handle));
+			RetireObject(described, semaphore, value);
+		}
+
+		/**
+		 * \brief Hands every object this vom manages to the deferred destruction queue, the device, instance and surfaces stay managed by this vom
+		 */
+		void RetireAll(vk::Semaphore semaphore, uint64_t value);
+
+		/**
+		 * \brief Destroys the retired objects whose timeline values were reached
+		 * \param wait Waits for every retired object instead of only destroying the finished ones
+		 */
+		void CollectRetired(bool wait = false);
+		uint64_t RetiredCount();
 		~ObjectManager();
 	private:
+		/**
+		 * \brief retiredMutex must be held while the returned vom is used
+		 */
+		ObjectManager& GetRetiredObjects(vk::Semaphore semaphore, uint64_t value);
+		void RetireObject(ManagedObject object, vk::Semaphore semaphore, uint64_t value);
+
+		static ManagedObject Describe(vk::Semaphore semaphore);
+		static ManagedObject Describe(vk::Fence fence);
+		static ManagedObject Describe(vk::CommandPool commandPool);
+		static ManagedObject Describe(vk::Framebuffer framebuffer);
+		static ManagedObject Describe(vk::RenderPass renderPass);
+		static ManagedObject Describe(vk::ShaderModule module);
+		static ManagedObject Describe(vk::Pipeline pipeline);
+		static ManagedObject Describe(vk::PipelineCache cache);
+		static ManagedObject Describe(vk::PipelineLayout layout);
+		static ManagedObject Describe(vk::Buffer buffer);
+		static ManagedObject Describe(vk::DeviceMemory memory);
+		static ManagedObject Describe(vk::DescriptorPool pool);
+		static ManagedObject Describe(vk::DescriptorSetLayout layout);
+		static ManagedObject Describe(vk::DescriptorUpdateTemplate updateTemplate);
+		static ManagedObject Describe(vk::Sampler sampler);
+		static ManagedObject Describe(vk::QueryPool queryPool);
+		static ManagedObject Describe(vk::Image image);
+		static ManagedObject Describe(vk::ImageView imageView);
+		static ManagedObject Describe(VmaBuffer buffer);
+		static ManagedObject Describe(VmaImage image);
+		static ManagedObject Describe(VmaAllocator allocator);
+		static ManagedObject Describe(vk::SwapchainKHR swapchain);
+		static ManagedObject Describe(SwapchainData swapchainData);
+		static ManagedObject Describe(vk::Device device);
+		static ManagedObject Describe(vk::SurfaceKHR surface);
+		static ManagedObject Describe(vk::Instance instance);
+
+		static uint32_t ShardIndex(ObjectType type, uint64_t handle);
+		ObjectHandle Register(ManagedObject object);
+		ObjectHandle Find(ObjectType type, uint64_t handle);
+		/**
+		 * \brief Takes the object out of the registry without destroying it, the last object is moved into its place
+		 */
+		bool Remove(ObjectHandle handle, ManagedObject* removed = nullptr);
+		/**
+		 * \brief The shard must be locked by the caller
+		 */
+		void RemoveSlot(RegistryShard& shard, uint32_t slot, ManagedObject* removed);
+		/**
+		 * \brief Takes every object the predicate accepts out of the registry, each shard is only locked while it is searched
+		 */
+		template<typename Predicate>
+		void TakeObjects(Predicate predicate, std::vector<ManagedObject>& taken);
+		void SetObjectTag(ObjectHandle handle, uint32_t tag);
+		void DestroyObject(const ManagedObject& object);
+
 		vk::Device device;
 		vk::PhysicalDevice physicalDevice;
 		vk::SurfaceKHR surface;
@@ -324,33 +570,30 @@ namespace vkt
 		QueueData computeQueue;
 		QueueData generalQueue;
 		VmaAllocator allocator;
+		VmaAllocatorCreateFlags allocatorFlags = 0;
+		EnabledFeatures enabledFeatures;
+		std::shared_ptr<ShaderCache> shaderCache;
+		std::shared_ptr<PersistentPipelineCache> pipelineCache;
+		std::shared_ptr<ObjectCache> objectCache;
 		
 		
-		std::deque<vk::Semaphore> semaphoresToDestroy;
-		std::deque<vk::Fence> fencesToDestroy;
-		std::deque<vk::CommandPool> commandPoolsToDestroy;
-		std::deque<vk::RenderPass> renderPassesToDestroy;
-		std::deque<vk::Pipeline> pipelineToDestroy;
-		std::deque<vk::PipelineLayout> pipelineLayoutsToDestroy;
-		std::deque<vk::Buffer> buffersToDestroy;
-		std::deque<vk::DeviceMemory> memoryAllocationsToDestroy;
-		std::deque<vk::Device> devicesToDestroy;
-		std::deque<vk::DescriptorPool> descriptorPoolsToDestroy;
-		std::deque<vk::DescriptorSetLayout> descriptorSetLayoutsToDestroy;
-		std::deque<vk::Instance> instancesToDestroy;
-		std::deque<vk::SurfaceKHR> surfacesToDestroy;
-		std::deque<vk::SwapchainKHR> swapchainsToDestroy;
-		std::deque<vk::Image> imagesToDestroy;
-		std::deque<vk::ImageView> imageViewsToDestroy;
-		std::deque<VmaBuffer> vmaBuffersToDestroy;
-		std::deque<VmaAllocator> allocatorsToDestroy;
-		std::deque<VmaImage> vmaImagesToDestroy;
-		std::deque<vk::ShaderModule> shaderModulesToDestroy;
-		std::deque<vk::Framebuffer> framebuffersToDestroy;
-		std::deque<vk::Sampler> samplersToDestroy;
+		std::array<RegistryShard, RegistryShardCount> shards;
+		std::atomic<uint32_t> currentTag = 0;
+		std::mutex retiredMutex;
+		std::vector<RetiredObjects> retiredObjects;
 		SwapchainData swapchainData;
 	};
 
+	/**
+	 * \brief Objects that were retired together, they are owned by a derived vom that destroys them once the semaphore reaches value
+	 */
+	struct RetiredObjects
+	{
+		vk::Semaphore semaphore;
+		uint64_t value;
+		std::unique_ptr<ObjectManager> objects;
+	};
+
 	class TimelineSemaphore
 	{
 	public:
@@ -398,27 +641,38 @@ namespace vkt
 	{
 		vk::Semaphore& semaphore;
 		std::shared_ptr<uint64_t>& signalValue;
-		vk::PipelineStageFlags& waitStage;
+		vk::PipelineStageFlags2& waitStage;
 		uint64_t index;
 
-		SemaphoreDataEntity(uint64_t _index, vk::Semaphore& semaphorePtr, std::shared_ptr<uint64_t>& signalValuePtr, vk::PipelineStageFlags& waitStagePtr);
+		SemaphoreDataEntity(uint64_t _index, vk::Semaphore& semaphorePtr, std::shared_ptr<uint64_t>& signalValuePtr, vk::PipelineStageFlags2& waitStagePtr);
 
 		void operator=(const SemaphoreDataEntity& ref);
 	};
 
+	/**
+	 * \brief Timeline entries either read their value through timelineValues when the submission is built or carry a fixed value set with EmplaceValue
+	 */
 	struct SemaphoreData
 	{
 		uint64_t timelineCount = 0;
-		std::vector<vk::Semaphore> semaphores;
-		std::vector<std::shared_ptr<uint64_t>> timelineValues;
-		std::vector<vk::PipelineStageFlags> waitStages;
-		std::vector<uint64_t> extractedTimelineValues;
+		InlineVector<vk::Semaphore, MaxSubmitSemaphores> semaphores;
+		InlineVector<std::shared_ptr<uint64_t>, MaxSubmitSemaphores> timelineValues;
+		InlineVector<uint64_t, MaxSubmitSemaphores> fixedValues;
+		InlineVector<bool, MaxSubmitSemaphores> isTimeline;
+		InlineVector<vk::PipelineStageFlags2, MaxSubmitSemaphores> waitStages;
+		InlineVector<uint64_t, MaxSubmitSemaphores> extractedTimelineValues;
 		SemaphoreDataEntity operator[](uint64_t index);
-		SemaphoreDataEntity EmplaceBack(vk::Semaphore semaphore, std::shared_ptr<uint64_t> signalValue, vk::PipelineStageFlags waitStage);
+		SemaphoreDataEntity EmplaceBack(vk::Semaphore semaphore, std::shared_ptr<uint64_t> signalValue, vk::PipelineStageFlags2 waitStage);
 		std::vector<SemaphoreDataEntity> EmplaceBack(std::vector<WaitData> datas);
+		SemaphoreDataEntity EmplaceValue(SemaphoreWait wait);
+		uint64_t GetValue(uint64_t index);
 		uint64_t size();
 		void ExtractTimelineValues();
 		uint32_t GetTimelineCount();
+		void Clear();
+
+	private:
+		SemaphoreDataEntity Insert(vk::Semaphore semaphore, std::shared_ptr<uint64_t> signalValue, uint64_t fixedValue, bool timeline, vk::PipelineStageFlags2 waitStage);
 	};
 
 	class SyncManager
@@ -427,17 +681,27 @@ namespace vkt
 		SyncManager(ObjectManager& _vom) : vom(_vom){}
 		SyncManager(vk::Device deviceHandle) : vom(deviceHandle){}
 
-		vk::TimelineSemaphoreSubmitInfo timelineSubmitInfo;
 		SemaphoreData waitSemaphores;
 		SemaphoreData signalSemaphores;
+		/**
+		 * \brief Waits that only apply to the next submission, GetWaitSubmitInfos adds them once and drops them
+		 */
+		SemaphoreWaits nextWaits;
 
 
-		void AttachWaitData(std::vector<WaitData> datas);
+		void AttachWaitData(const std::vector<WaitData>& datas);
+		void AttachWaitData(const WaitData& data);
+		void AttachWait(SemaphoreWait wait);
+		void AttachNextWait(SemaphoreWait wait);
 		void CreateTimelineSignalSemaphore(uint64_t startValue);
 		void CreateTimelineSignalSemaphore(std::shared_ptr<uint64_t> startAndSignalValuePtr);
 		void CreateSignalSemaphore();
-		vk::TimelineSemaphoreSubmitInfo GetTimelineSubmitInfo(bool withNormalWaits = true, bool withNormalSignals = true);
-		vk::TimelineSemaphoreSubmitInfo* GetTimelineSubmitInfoPtr(bool withNormalWaits = true, bool withNormalSignals = true);
+
+		/**
+		 * \brief Fills infos with the current values, the storage is reused between submissions so building them does not allocate
+		 */
+		void GetWaitSubmitInfos(InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores>& infos, bool withNormalWaits = true);
+		void GetSignalSubmitInfos(InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores>& infos, bool withNormalSignals = true);
 		void Clear();
 		void ClearWaits();
 		void ClearSignals();
@@ -0,0 +1,43 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief A pipeline cache that is loaded from disk when it was written by the same driver and device and saved back when it is released
+	 * Attach it to a vom with SetPipelineCache so that every MakePipeline without an explicit cache uses it, including the pipeline managers made from that vom
+	 */
+	class PersistentPipelineCache
+	{
+	public:
+		/**
+		 * \param _vom A vom with a physical device mounted, the properties of that device decide whether the file on disk can be used
+		 * \param _path The file the cache is read from and written to
+		 */
+		PersistentPipelineCache(ObjectManager& _vom, std::string _path);
+		~PersistentPipelineCache();
+
+		vk::PipelineCache GetCache();
+
+		/**
+		 * \brief Writes the cache to a temporary file next to the path and renames it over the old one once it is flushed to the disk and closed, so a crash while saving never leaves a broken cache behind
+		 * \return Whether the file was written
+		 */
+		bool Save();
+
+		/**
+		 * \brief Whether the cache started from the file on disk instead of empty
+		 */
+		bool LoadedFromDisk();
+
+	private:
+		/**
+		 * \brief Checks the header the driver writes in front of the cache data against the physical device
+		 */
+		bool Validate(const uint8_t* data, size_t size);
+
+		ObjectManager vom;
+		vk::PhysicalDeviceProperties properties;
+		std::string path;
+		vk::PipelineCache cache;
+		bool loaded = false;
+	};
+}
@@ -1,11 +1,59 @@
 #pragma once
 namespace vkt
 {
+	/**
+	 * \brief A pipeline manager that is built by a job, the caller can keep going and only waits once it needs the pipeline
+	 */
+	template<typename T>
+	class AsyncPipeline
+	{
+	public:
+		AsyncPipeline() = default;
+		AsyncPipeline(JobSystem& _jobs, JobHandle _job, std::shared_ptr<std::unique_ptr<T>> _result)
+			: jobs(&_jobs), job(std::move(_job)), result(std::move(_result))
+		{
+		}
+
+		bool IsReady()
+		{
+			return job != nullptr && jobs->IsFinished(job);
+		}
+
+		/**
+		 * \brief Waits for the build to finish, the calling thread runs other jobs in the meantime
+		 */
+		T& Get()
+		{
+			assert(job != nullptr);
+			jobs->Wait(job);
+			return **result;
+		}
+
+		/**
+		 * \brief The job that builds the pipeline, other jobs can depend on it
+		 */
+		JobHandle GetJob()
+		{
+			return job;
+		}
+
+	private:
+		JobSystem* jobs = nullptr;
+		JobHandle job;
+		std::shared_ptr<std::unique_ptr<T>> result;
+	};
+
 	struct ComputePipelineManager
 	{
 		ComputePipelineManager(ObjectManager& _vom, vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo, const char* shaderPath);
 		ComputePipelineManager(vk::Device deviceHandle, vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo, const char* shaderPath);
 
+		/**
+		 * \brief Builds the pipeline on a worker of the job system, the arrays the layout create info points at are copied so they do not have to outlive the call
+		 * \param _vom Must outlive the build, the pipeline is compiled against the pipeline cache attached to it
+		 */
+		static AsyncPipeline<ComputePipelineManager> BuildAsync(JobSystem& jobs, ObjectManager& _vom, vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo, std::string shaderPath, std::vector<JobHandle> dependencies = {});
+
 		ObjectManager vom;
 		vk::Pipeline computePipeline;
 		vk::PipelineLayout layout;
@@ -66,6 +114,25 @@ namespace vkt
 			vk::PipelineColorBlendStateCreateInfo colorBlendState,
 			vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo);
 
+		/**
+		 * \brief Builds the pipeline on a worker of the job system, the shader paths and the arrays the layout create info points at are copied
+		 * \param _vom Must outlive the build, the pipeline is compiled against the pipeline cache attached to it
+		 */
+		static AsyncPipeline<GraphicsPipelineManager> BuildAsync(JobSystem& jobs, ObjectManager& _vom,
+			vk::RenderPass _renderPass,
+			std::vector<std::string> shaderPaths,
+			std::vector<vk::ShaderStageFlagBits> shaderStageFlagBits,
+			std::vector<vk::VertexInputBindingDescription> vertexBindings, std::vector<vk::VertexInputAttributeDescription> vertexAttributes,
+			vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState,
+			vk::Viewport viewport, vk::Rect2D scissor,
+			vk::PipelineRasterizationStateCreateInfo rasterizationState,
+			vk::PipelineMultisampleStateCreateInfo multisampleState,
+			vk::PipelineDepthStencilStateCreateInfo depthStencilState,
+			std::vector<vk::PipelineColorBlendAttachmentState> colorBlendAttachments,
+			vk::PipelineColorBlendStateCreateInfo colorBlendState,
+			vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo,
+			std::vector<JobHandle> dependencies = {});
+
 		vk::PipelineLayout layout;
 		vk::Pipeline pipeline;
 		ObjectManager vom;
@@ -0,0 +1,78 @@
+#pragma once
+namespace vkt
+{
+	struct PipelineStatisticsZone
+	{
+		std::string name;
+		uint32_t query;
+		uint64_t objectCount;
+	};
+
+	struct PipelineStatisticsFrame
+	{
+		std::vector<PipelineStatisticsZone> zones;
+		uint64_t submitValue = 0;
+		bool pending = false;
+	};
+
+	/**
+	 * \brief The latest counters of all zones with the same name, counters that were not collected stay zero
+	 */
+	struct PipelineStatisticsReport
+	{
+		std::string name;
+		uint64_t objectCount = 0;
+		uint64_t vertexInvocations = 0;
+		uint64_t clippingPrimitives = 0;
+		uint64_t fragmentInvocations = 0;
+		uint64_t computeInvocations = 0;
+		double vertexInvocationsPerObject = 0;
+		double clippingPrimitivesPerObject = 0;
+		double fragmentInvocationsPerObject = 0;
+		double computeInvocationsPerObject = 0;
+
+		/**
+		 * \brief Compute invocations beyond one per object, like the tail of a dispatch that is rounded up to the workgroup size
+		 */
+		uint64_t excessComputeInvocations = 0;
+	};
+
+	/**
+	 * \brief Collects pipeline statistics queries around zones of command buffers, results are read like the timestamp profiler once the submission finished
+	 * NOTE: Needs the pipelineStatisticsQuery device feature, graphics counters are only valid on queues with graphics support
+	 */
+	class PipelineStatisticsProfiler
+	{
+	public:
+		PipelineStatisticsProfiler() = default;
+		PipelineStatisticsProfiler(ObjectManager& _vom, vk::Semaphore _timeline, vk::QueryPipelineStatisticFlags _statistics, uint32_t _maxZones = 32, uint32_t framesInFlight = 4);
+
+		bool Enabled();
+
+		/**
+		 * \brief Begins the query of a zone, zones can not be nested and a zone that begins outside of a render pass must also end outside of it
+		 * \param objectCount The amount of objects the zone processes, the report divides the counters by it
+		 */
+		void BeginZone(vk::CommandBuffer cmd, std::string name, uint64_t objectCount);
+		void EndZone(vk::CommandBuffer cmd);
+		void EndFrame(uint64_t submitValue);
+		void Resolve();
+		std::vector<PipelineStatisticsReport> GetReports();
+
+	private:
+		void ResolveFrame(PipelineStatisticsFrame& frame, uint32_t frameIndex);
+
+		vk::Device device;
+		vk::Semaphore timeline;
+		vk::QueryPool queryPool;
+		vk::QueryPipelineStatisticFlags statistics;
+		uint32_t statisticCount = 0;
+		uint32_t maxZones = 0;
+		uint32_t currentFrame = 0;
+		bool zoneOpen = false;
+		bool zoneSkipped = false;
+		std::vector<PipelineStatisticsFrame> frames;
+		std::vector<uint64_t> results;
+		std::vector<PipelineStatisticsReport> reports;
+	};
+}
@@ -0,0 +1,106 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief 64 bit FNV-1a hash of a block of memory
+	 */
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+	/**
+	 * \brief A whole file mapped read only into memory, the mapping lives as long as the object
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile(const char* path);
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool IsOpen();
+		const uint8_t* Data();
+		size_t Size();
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+	#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+	#else
+		int fileDescriptor = -1;
+	#endif
+	};
+
+	struct CachedShaderFile
+	{
+		/**
+		 * \brief The key of the module in the cache, the hash of the contents unless another module with different contents already had it
+		 */
+		uint64_t moduleKey = 0;
+		std::filesystem::file_time_type writeTime;
+	};
+
+	struct CachedShaderModule
+	{
+		vk::ShaderModule module;
+		std::vector<uint32_t> code;
+		uint32_t users = 0;
+	};
+
+	/**
+	 * \brief Keeps shader modules alive across pipeline rebuilds, files are mapped instead of read and files with the same contents share one module
+	 * Attach it to a vom with SetShaderCache so that MakeShaderModule and the pipeline managers go through it, the modules belong to the cache and not to the vom
+	 * Every function can be called from any thread, but a module must not be used for pipeline creation while a Poll or Invalidate could replace it
+	 */
+	class ShaderCache
+	{
+	public:
+		ShaderCache(ObjectManager& _vom);
+		ShaderCache(vk::Device deviceHandle);
+
+		/**
+		 * \brief Returns the module of the file, the file is only read once unless watching is on and it changed on disk
+		 * A file that can not be mapped or is not whole SPIR-V words keeps its previous module, a file that was never loaded returns a null module
+		 */
+		vk::ShaderModule Get(const char* shaderPath);
+
+		/**
+		 * \brief Returns the module for the given SPIR-V, code that was loaded before from any file or buffer reuses its module
+		 */
+		vk::ShaderModule Get(const uint32_t* code, size_t codeSize);
+
+		/**
+		 * \brief With watching on, every Get compares the write time of the file and reloads it when it changed
+		 */
+		void SetWatching(bool watch);
+
+		/**
+		 * \brief Reloads every cached file whose write time changed, files that fail to load are tried again on the next Poll
+		 * \return The paths whose module was replaced, their pipelines need to be rebuilt
+		 */
+		std::vector<std::string> Poll();
+
+		/**
+		 * \brief Forgets a file, its module is destroyed once no other file uses the same contents
+		 */
+		void Invalidate(const char* shaderPath);
+		void Clear();
+		uint64_t ModuleCount();
+
+	private:
+		vk::ShaderModule Load(const std::string& path, bool reload);
+		/**
+		 * \brief Modules with the same hash are only shared when their code is the same, a different module under that hash moves to the next free key
+		 * \return The key of the module
+		 */
+		uint64_t Acquire(const uint32_t* code, size_t codeSize);
+		void ReleaseModule(uint64_t key);
+
+		ObjectManager vom;
+		std::mutex mutex;
+		bool watching = false;
+		std::unordered_map<std::string, CachedShaderFile> files;
+		std::unordered_map<uint64_t, CachedShaderModule> modules;
+	};
+}
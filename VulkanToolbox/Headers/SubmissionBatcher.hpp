@@ -0,0 +1,65 @@
+#pragma once
+namespace vkt
+{
+	constexpr size_t MaxSubmitCommandBuffers = 32;
+
+	/**
+	 * \brief A single submission that has been handed to a SubmissionBatcher, all timeline values are captured at the time the submission is added
+	 * Everything is stored inline so that handing a submission over does not allocate
+	 */
+	struct BatchedSubmit
+	{
+		InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores> waits;
+		InlineVector<vk::CommandBufferSubmitInfo, MaxSubmitCommandBuffers> commandBuffers;
+		InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores> signals;
+
+		void Assign(std::span<const vk::SemaphoreSubmitInfo> _waits, std::span<const vk::CommandBufferSubmitInfo> _commandBuffers, std::span<const vk::SemaphoreSubmitInfo> _signals);
+	};
+
+	/**
+	 * \brief All of the submissions a SubmissionBatcher has collected for one queue, the batch stays after a flush so its storage is reused
+	 */
+	struct QueueBatch
+	{
+		QueueData queue;
+		std::vector<BatchedSubmit> submits;
+		std::vector<vk::SubmitInfo2> submitInfos;
+	};
+
+	/**
+	 * \brief The submission batcher collects the submissions of many command managers and flushes them with a single vkQueueSubmit2 per queue
+	 * NOTE: Queues are flushed in the order they were first added to, the toolbox relies on timeline semaphores which allow a wait to be submitted before its signal
+	 */
+	class SubmissionBatcher
+	{
+	public:
+		SubmissionBatcher() = default;
+
+		/**
+		 * \brief Adds a submission to the batch of the target queue, the infos are copied so they can change right after the call
+		 * \param queue The queue the submission will be flushed to
+		 * \param waits The semaphores the submission waits on, timeline values must already be resolved
+		 * \param commandBuffers The command buffers of the submission
+		 * \param signals The semaphores the submission signals, timeline values must already be resolved
+		 */
+		void Add(QueueData queue, std::span<const vk::SemaphoreSubmitInfo> waits, std::span<const vk::CommandBufferSubmitInfo> commandBuffers, std::span<const vk::SemaphoreSubmitInfo> signals);
+
+		/**
+		 * \brief Submits every collected submission, one vkQueueSubmit2 per queue, and clears the batcher
+		 * \param fence An optional fence to signal, only valid when the batch targets a single queue
+		 */
+		void Flush(vk::Fence fence = {});
+
+		/**
+		 * \brief Drops every collected submission without submitting it
+		 */
+		void Clear();
+
+		bool Empty();
+		uint64_t QueueCount();
+		uint64_t SubmitCount();
+
+	private:
+		std::vector<QueueBatch> queueBatches;
+	};
+}
@@ -0,0 +1,74 @@
+#pragma once
+namespace vkt
+{
+	/**
+	 * \brief A submission or present that waits in the queue of a submission thread
+	 */
+	struct ThreadedSubmit
+	{
+		BatchedSubmit submit;
+		vk::Fence fence;
+		bool present = false;
+		vk::SwapchainKHR swapchain;
+		uint32_t imageIndex = 0;
+		vk::Semaphore presentWait;
+	};
+
+	/**
+	 * \brief The submission thread owns all submissions to one queue, any thread can enqueue work without locking while the thread drains the queue
+	 * Everything that is waiting when the thread wakes up is submitted with as few vkQueueSubmit2 calls as the fences allow
+	 * NOTE: Once a queue has a submission thread, every submission and present to that queue must go through it
+	 */
+	class SubmissionThread
+	{
+	public:
+		SubmissionThread(ObjectManager& _vom, QueueData _queue);
+		SubmissionThread(vk::Device deviceHandle, QueueData _queue);
+		~SubmissionThread();
+
+		/**
+		 * \brief Enqueues a submission, timeline values must already be resolved since the submission happens later on the thread
+		 * The infos are copied inline into a slot of the queue, so nothing is allocated, a full queue blocks until the thread made room
+		 * \param fence Signaled once this submission and the ones submitted with it finished
+		 */
+		void Enqueue(std::span<const vk::SemaphoreSubmitInfo> waits, std::span<const vk::CommandBufferSubmitInfo> commandBuffers, std::span<const vk::SemaphoreSubmitInfo> signals, vk::Fence fence = {});
+
+		/**
+		 * \brief Enqueues a present of a swapchain image, it reaches the queue after every submission enqueued before it
+		 * \param waitSemaphore A binary semaphore signaled by an earlier submission, can be null
+		 */
+		void EnqueuePresent(vk::SwapchainKHR swapchain, uint32_t imageIndex, vk::Semaphore waitSemaphore);
+
+		/**
+		 * \brief Blocks until everything enqueued before the call has been handed to the queue, this does not wait for the gpu
+		 */
+		void Flush();
+
+		/**
+		 * \brief Submits what is left and stops the thread
+		 */
+		void Stop();
+
+		uint64_t EnqueuedCount();
+		uint64_t SubmittedCount();
+		QueueData GetQueue();
+
+	private:
+		void Start();
+		void Notify();
+		void Run();
+		void Submit(std::vector<ThreadedSubmit>& batch);
+
+		ObjectManager vom;
+		QueueData queue;
+		static constexpr size_t QueueCapacity = 64;
+
+		MpscQueue<ThreadedSubmit, QueueCapacity> submissions;
+		std::vector<vk::SubmitInfo2> submitInfos;
+		std::atomic<uint64_t> enqueued = 0;
+		std::atomic<uint64_t> submitted = 0;
+		std::atomic<uint64_t> wakeCount = 0;
+		std::atomic<bool> running = false;
+		std::thread worker;
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+namespace vkt
+{
+	struct TimestampZone
+	{
+		std::string name;
+		uint32_t beginQuery;
+		uint32_t endQuery;
+	};
+
+	/**
+	 * \brief The zones of one submission, its queries can only be reused once the submission finished and the results were read
+	 */
+	struct ProfilerFrame
+	{
+		std::vector<TimestampZone> zones;
+		uint32_t usedQueries = 0;
+		uint64_t submitValue = 0;
+		bool pending = false;
+	};
+
+	/**
+	 * \brief Rolling gpu timings of all zones with the same name
+	 */
+	struct ZoneStatistics
+	{
+		std::string name;
+		double lastMs = 0;
+		double averageMs = 0;
+		double minMs = 0;
+		double maxMs = 0;
+		std::deque<double> history;
+	};
+
+	/**
+	 * \brief The timestamp profiler times scoped zones of command buffers with a timestamp query pool
+	 * Results are read once the timeline value of the submission that contained the zones is reached, so they lag a few submissions behind
+	 */
+	class TimestampProfiler
+	{
+	public:
+		TimestampProfiler() = default;
+
+		/**
+		 * \param _vom The vom that will own the query pool
+		 * \param _timeline The timeline semaphore that the submissions containing the zones signal
+		 * \param _timestampPeriod The nanoseconds per timestamp tick of the physical device
+		 * \param maxZones The maximum amount of zones in a single submission, further zones are ignored
+		 * \param framesInFlight The amount of submissions that can be waiting for their results before a new zone blocks
+		 * \param _historySize The amount of samples the rolling statistics cover
+		 */
+		TimestampProfiler(ObjectManager& _vom, vk::Semaphore _timeline, float _timestampPeriod, uint32_t maxZones = 64, uint32_t framesInFlight = 4, uint32_t _historySize = 120);
+
+		bool Enabled();
+
+		/**
+		 * \brief Writes the begin timestamp of a zone, zones can be nested and must be outside of render passes if they are the first zone of a submission
+		 */
+		void BeginZone(vk::CommandBuffer cmd, std::string name);
+		void EndZone(vk::CommandBuffer cmd);
+
+		/**
+		 * \brief Marks the zones recorded so far as part of the submission that signals submitValue
+		 */
+		void EndFrame(uint64_t submitValue);
+
+		/**
+		 * \brief Reads the results of every submission that finished, never blocks
+		 */
+		void Resolve();
+
+		std::vector<ZoneStatistics> GetStatistics();
+
+	private:
+		void ResolveFrame(ProfilerFrame& frame, uint32_t frameIndex);
+
+		vk::Device device;
+		vk::Semaphore timeline;
+		vk::QueryPool queryPool;
+		float timestampPeriod = 1;
+		uint32_t queriesPerFrame = 0;
+		uint32_t historySize = 0;
+		uint32_t currentFrame = 0;
+		std::vector<ProfilerFrame> frames;
+		std::vector<uint32_t> openZones;
+		std::vector<uint64_t> results;
+		std::vector<ZoneStatistics> statistics;
+	};
+}
@@ -1,7 +1,19 @@
 #pragma once
 
 #include <memory>
+#include <array>
 #include <deque>
+#include <unordered_map>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
 #include <vulkan/vulkan.hpp>
 #include <vk_mem_alloc.h>
 #define GLFW_INCLUDE_VULKAN
@@ -10,11 +22,27 @@
 
 
 #undef MemoryBarrier
+#include "Containers.hpp"
 #include "ObjectManager.hpp"
+#include "ShaderCache.hpp"
+#include "ObjectCache.hpp"
+#include "PipelineCache.hpp"
+#include "ImmediateSubmit.hpp"
+#include "SubmissionBatcher.hpp"
+#include "SubmissionThread.hpp"
+#include "TimestampProfiler.hpp"
+#include "PipelineStatisticsProfiler.hpp"
 #include "CommandManager.hpp"
+#include "CompletionService.hpp"
+#include "JobSystem.hpp"
 #include "MemoryManager.hpp"
+#include "IndirectCommands.hpp"
 #include "DescriptorManager.hpp"
+#include "BindlessTable.hpp"
+#include "DescriptorTemplates.hpp"
 #include "RenderpassManager.hpp"
 #include "PipelineManagers.hpp"
+#include "FrameGraph.hpp"
 #include "VulkanWindow.hpp"
+#include "Headless.hpp"
 #define MemoryBarrier __faststorefence
@@ -0,0 +1,307 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	DescriptorIndexAllocator::DescriptorIndexAllocator(uint32_t _capacity) : capacity(_capacity) {}
+
+	uint32_t DescriptorIndexAllocator::Allocate()
+	{
+		if (!freeIndices.empty())
+		{
+			uint32_t index = freeIndices.back();
+			freeIndices.pop_back();
+			return index;
+		}
+		if (next == capacity)
+		{
+			return UINT32_MAX;
+		}
+		return next++;
+	}
+	void DescriptorIndexAllocator::Free(uint32_t index)
+	{
+		assert(index < next);
+		freeIndices.emplace_back(index);
+	}
+	uint32_t DescriptorIndexAllocator::Capacity()
+	{
+		return capacity;
+	}
+	uint32_t DescriptorIndexAllocator::InUse()
+	{
+		return next - freeIndices.size();
+	}
+
+	BindlessTable::BindlessTable(ObjectManager& _vom, vk::ShaderStageFlags _stages, BindlessLimits _limits) : vom(_vom), limits(_limits)
+	{
+		auto properties = _vom.GetPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>().get<vk::PhysicalDeviceVulkan12Properties>();
+		limits.storageBuffers = (std::min)({ limits.storageBuffers, properties.maxDescriptorSetUpdateAfterBindStorageBuffers, properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+		limits.sampledImages = (std::min)({ limits.sampledImages, properties.maxDescriptorSetUpdateAfterBindSampledImages, properties.maxPerStageDescriptorUpdateAfterBindSampledImages });
+		limits.samplers = (std::min)({ limits.samplers, properties.maxDescriptorSetUpdateAfterBindSamplers, properties.maxPerStageDescriptorUpdateAfterBindSamplers });
+		//Every stage sees all three arrays, so together they also have to fit the per stage resource limit
+		uint64_t total = uint64_t(limits.storageBuffers) + limits.sampledImages + limits.samplers;
+		if (total > properties.maxPerStageUpdateAfterBindResources)
+		{
+			double scale = double(properties.maxPerStageUpdateAfterBindResources) / double(total);
+			limits.storageBuffers = uint32_t(limits.storageBuffers * scale);
+			limits.sampledImages = uint32_t(limits.sampledImages * scale);
+			limits.samplers = uint32_t(limits.samplers * scale);
+		}
+		bufferIndices = DescriptorIndexAllocator(limits.storageBuffers);
+		imageIndices = DescriptorIndexAllocator(limits.sampledImages);
+		samplerIndices = DescriptorIndexAllocator(limits.samplers);
+
+		std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {
+			vk::DescriptorSetLayoutBinding(StorageBufferBinding, vk::DescriptorType::eStorageBuffer, limits.storageBuffers, _stages),
+			vk::DescriptorSetLayoutBinding(SampledImageBinding, vk::DescriptorType::eSampledImage, limits.sampledImages, _stages),
+			vk::DescriptorSetLayoutBinding(SamplerBinding, vk::DescriptorType::eSampler, limits.samplers, _stages)
+		};
+		//Unused while pending lets Update write indices that in flight command buffers do not touch
+		vk::DescriptorBindingFlags bindingFlag = vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+		std::array<vk::DescriptorBindingFlags, 3> bindingFlags = { bindingFlag, bindingFlag, bindingFlag };
+		vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo(bindingFlags.size(), bindingFlags.data());
+		layout = vom.MakeDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, bindings.size(), bindings.data(), &bindingFlagsInfo));
+
+		std::array<vk::DescriptorPoolSize, 3> poolSizes = {
+			vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, limits.storageBuffers),
+			vk::DescriptorPoolSize(vk::DescriptorType::eSampledImage, limits.sampledImages),
+			vk::DescriptorPoolSize(vk::DescriptorType::eSampler, limits.samplers)
+		};
+		pool = vom.MakeDescriptorPool(vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, poolSizes.size(), poolSizes.data()));
+		set = vom.MakeDescriptorSets(vk::DescriptorSetAllocateInfo(pool, 1, &layout))[0];
+	}
+
+	void BindlessTable::RequireFeatures(VkPhysicalDeviceVulkan12Features& features12)
+	{
+		features12.runtimeDescriptorArray = VK_TRUE;
+		features12.descriptorBindingPartiallyBound = VK_TRUE;
+		features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		features12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+		features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		features12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+		features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+	}
+	bool BindlessTable::Supported(vk::PhysicalDevice physicalDevice)
+	{
+		auto features12 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>().get<vk::PhysicalDeviceVulkan12Features>();
+		return features12.runtimeDescriptorArray
+			&& features12.descriptorBindingPartiallyBound
+			&& features12.descriptorBindingUpdateUnusedWhilePending
+			&& features12.descriptorBindingStorageBufferUpdateAfterBind
+			&& features12.descriptorBindingSampledImageUpdateAfterBind
+			&& features12.shaderStorageBufferArrayNonUniformIndexing
+			&& features12.shaderSampledImageArrayNonUniformIndexing;
+	}
+
+	uint32_t BindlessTable::AddSector(std::shared_ptr<SectorData> sector)
+	{
+		assert(sector->bufferAllocation->bufferCreateInfo.usage & vk::BufferUsageFlagBits::eStorageBuffer);
+		assert(sectors.find(sector.get()) == sectors.end());
+		auto srcVersion = sector->bufferAllocation->cmdManager.GetSubmitCountPtr();
+		vk::DescriptorBufferInfo bInfo(sector->bufferAllocation->bufferData.buffer, sector->allocationOffset, sector->neededSize);
+		uint32_t index = AddBuffer(bInfo);
+		if (index == UINT32_MAX)
+		{
+			return index;
+		}
+		sectors[sector.get()] = BindlessSector{ sector, srcVersion, bInfo, index };
+		auto group = std::find_if(sectorGroups.begin(), sectorGroups.end(), [&srcVersion](BindlessSectorGroup& known) { return known.srcVersion == srcVersion; });
+		if (group == sectorGroups.end())
+		{
+			sectorGroups.emplace_back(BindlessSectorGroup{ srcVersion, std::atomic_ref<uint64_t>(*srcVersion).load(std::memory_order_acquire) });
+			group = sectorGroups.end() - 1;
+		}
+		group->sectors.emplace_back(sector.get());
+		return index;
+	}
+	uint32_t BindlessTable::GetSectorIndex(const std::shared_ptr<SectorData>& sector)
+	{
+		auto tracked = sectors.find(sector.get());
+		assert(tracked != sectors.end());
+		return tracked->second.index;
+	}
+	void BindlessTable::RemoveSector(const std::shared_ptr<SectorData>& sector, vk::Semaphore semaphore, uint64_t value)
+	{
+		auto tracked = sectors.find(sector.get());
+		if (tracked == sectors.end())
+		{
+			return;
+		}
+		for (auto& group : sectorGroups)
+		{
+			if (group.srcVersion == tracked->second.srcVersion)
+			{
+				std::erase(group.sectors, sector.get());
+			}
+		}
+		std::erase_if(sectorGroups, [](BindlessSectorGroup& group) { return group.sectors.empty(); });
+		Remove(StorageBufferBinding, tracked->second.index, semaphore, value);
+		sectors.erase(tracked);
+	}
+	uint32_t BindlessTable::AddBuffer(vk::DescriptorBufferInfo bufferInfo)
+	{
+		uint32_t index = bufferIndices.Allocate();
+		assert(index != UINT32_MAX);
+		if (index != UINT32_MAX)
+		{
+			SetBuffer(index, bufferInfo);
+		}
+		return index;
+	}
+	uint32_t BindlessTable::AddImage(vk::ImageView view, vk::ImageLayout layout)
+	{
+		uint32_t index = imageIndices.Allocate();
+		assert(index != UINT32_MAX);
+		if (index != UINT32_MAX)
+		{
+			SetImage(index, view, layout);
+		}
+		return index;
+	}
+	uint32_t BindlessTable::AddSampler(vk::Sampler sampler)
+	{
+		uint32_t index = samplerIndices.Allocate();
+		assert(index != UINT32_MAX);
+		if (index != UINT32_MAX)
+		{
+			pendingWrites.emplace_back(PendingBindlessWrite{ SamplerBinding, index, {}, vk::DescriptorImageInfo(sampler) });
+		}
+		return index;
+	}
+	void BindlessTable::SetBuffer(uint32_t index, vk::DescriptorBufferInfo bufferInfo)
+	{
+		pendingWrites.emplace_back(PendingBindlessWrite{ StorageBufferBinding, index, bufferInfo, {} });
+	}
+	void BindlessTable::SetImage(uint32_t index, vk::ImageView view, vk::ImageLayout layout)
+	{
+		pendingWrites.emplace_back(PendingBindlessWrite{ SampledImageBinding, index, {}, vk::DescriptorImageInfo({}, view, layout) });
+	}
+
+	void BindlessTable::RemoveBuffer(uint32_t index, vk::Semaphore semaphore, uint64_t value)
+	{
+		Remove(StorageBufferBinding, index, semaphore, value);
+	}
+	void BindlessTable::RemoveImage(uint32_t index, vk::Semaphore semaphore, uint64_t value)
+	{
+		Remove(SampledImageBinding, index, semaphore, value);
+	}
+	void BindlessTable::RemoveSampler(uint32_t index, vk::Semaphore semaphore, uint64_t value)
+	{
+		Remove(SamplerBinding, index, semaphore, value);
+	}
+
+	void BindlessTable::Update()
+	{
+		//Sectors are only looked at when the buffer manager they live in submitted something since the last Update
+		for (auto& group : sectorGroups)
+		{
+			uint64_t srcVersion = std::atomic_ref<uint64_t>(*group.srcVersion).load(std::memory_order_acquire);
+			if (group.version == srcVersion)
+			{
+				continue;
+			}
+			group.version = srcVersion;
+			for (auto sector : group.sectors)
+			{
+				auto& tracked = sectors[sector];
+				vk::DescriptorBufferInfo bInfo(sector->bufferAllocation->bufferData.buffer, sector->allocationOffset, sector->neededSize);
+				if (bInfo == tracked.bInfo)
+				{
+					continue;
+				}
+				//In flight frames may still read the old index, so the moved sector is written to a new one
+				uint32_t index = bufferIndices.Allocate();
+				assert(index != UINT32_MAX);
+				if (index == UINT32_MAX)
+				{
+					continue;
+				}
+				vk::Semaphore semaphore = releaseSemaphore;
+				uint64_t value = (releaseSemaphore != VK_NULL_HANDLE) ? std::atomic_ref<uint64_t>(*releaseValue).load(std::memory_order_acquire) : 0;
+				Remove(StorageBufferBinding, tracked.index, semaphore, value);
+				tracked.index = index;
+				tracked.bInfo = bInfo;
+				SetBuffer(index, bInfo);
+			}
+		}
+
+		//The pending writes no longer grow, so the writes can point into them
+		writes.clear();
+		for (auto& pending : pendingWrites)
+		{
+			switch (pending.binding)
+			{
+			case StorageBufferBinding:
+				writes.emplace_back(vk::WriteDescriptorSet(set, pending.binding, pending.index, 1, vk::DescriptorType::eStorageBuffer, {}, &pending.bInfo, {}));
+				break;
+			case SampledImageBinding:
+				writes.emplace_back(vk::WriteDescriptorSet(set, pending.binding, pending.index, 1, vk::DescriptorType::eSampledImage, &pending.iInfo, {}, {}));
+				break;
+			case SamplerBinding:
+				writes.emplace_back(vk::WriteDescriptorSet(set, pending.binding, pending.index, 1, vk::DescriptorType::eSampler, &pending.iInfo, {}, {}));
+				break;
+			}
+		}
+		if (!writes.empty())
+		{
+			vom.GetDevice().updateDescriptorSets(writes.size(), writes.data(), 0, {});
+		}
+		pendingWrites.clear();
+
+		for (size_t i = 0; i < pendingFrees.size();)
+		{
+			auto& pending = pendingFrees[i];
+			if (pending.semaphore == VK_NULL_HANDLE || vom.GetDevice().getSemaphoreCounterValue(pending.semaphore) >= pending.value)
+			{
+				Allocator(pending.binding).Free(pending.index);
+				pendingFrees[i] = pendingFrees.back();
+				pendingFrees.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+	void BindlessTable::ReleaseOn(vk::Semaphore semaphore, std::shared_ptr<uint64_t> valuePtr)
+	{
+		releaseSemaphore = semaphore;
+		releaseValue = valuePtr;
+	}
+	void BindlessTable::Bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex)
+	{
+		cmd.bindDescriptorSets(bindPoint, pipelineLayout, setIndex, 1, &set, 0, {});
+	}
+
+	vk::DescriptorSet BindlessTable::GetSet()
+	{
+		return set;
+	}
+	vk::DescriptorSetLayout BindlessTable::GetLayout()
+	{
+		return layout;
+	}
+	BindlessLimits BindlessTable::GetLimits()
+	{
+		return limits;
+	}
+
+	DescriptorIndexAllocator& BindlessTable::Allocator(uint32_t binding)
+	{
+		switch (binding)
+		{
+		case SampledImageBinding:
+			return imageIndices;
+		case SamplerBinding:
+			return samplerIndices;
+		default:
+			return bufferIndices;
+		}
+	}
+	void BindlessTable::Remove(uint32_t binding, uint32_t index, vk::Semaphore semaphore, uint64_t value)
+	{
+		//A write that is still pending for the index would land after it was handed out again
+		std::erase_if(pendingWrites, [binding, index](PendingBindlessWrite& pending) { return pending.binding == binding && pending.index == index; });
+		pendingFrees.emplace_back(PendingBindlessFree{ binding, index, semaphore, value });
+	}
+}
@@ -2,7 +2,7 @@
 
 namespace vkt
 {
-	CommandManager::CommandManager(ObjectManager& _vom, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount)
+	CommandManager::CommandManager(ObjectManager& _vom, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount)
 		: syncManager(_vom), vom(_vom)
 	{
 		vom.SetGeneralQueue(targetQueue);
@@ -20,7 +20,7 @@ namespace vkt
 		fence = vom.MakeFence(false);
 		targetStages = _targetStages;
 	}
-	CommandManager::CommandManager(ObjectManager& _vom, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount)
+	CommandManager::CommandManager(ObjectManager& _vom, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount)
 		: syncManager(_vom), vom(_vom)
 	{
 		vom.SetDevice(_vom.GetDevice());
@@ -33,7 +33,7 @@ namespace vkt
 		fence = vom.MakeFence(false);
 		targetStages = _targetStages;
 	}
-	CommandManager::CommandManager(vk::Device deviceHandle, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount)
+	CommandManager::CommandManager(vk::Device deviceHandle, QueueData targetQueue, bool createInternalCommandPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount)
 		: syncManager(deviceHandle), vom(deviceHandle)
 	{
 		vom.SetGeneralQueue(targetQueue);
@@ -51,7 +51,7 @@ namespace vkt
 		fence = vom.MakeFence(false);
 		targetStages = _targetStages;
 	}
-	CommandManager::CommandManager(vk::Device deviceHandle, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags _targetStages, uint64_t startingSubmitCount)
+	CommandManager::CommandManager(vk::Device deviceHandle, QueueData targetQueue, vk::CommandPool externalPool, vk::PipelineStageFlags2 _targetStages, uint64_t startingSubmitCount)
 		: syncManager(deviceHandle), vom(deviceHandle)
 	{
 		vom.SetGeneralQueue(targetQueue);
@@ -68,19 +68,82 @@ namespace vkt
 	{
 		return cmdCache.NextCommandBuffer();
 	}
-	void CommandManager::DependsOn(std::vector<WaitData> waits)
+	vk::CommandBuffer CommandManager::RecordCached(uint64_t key, uint64_t version, std::function<void(vk::CommandBuffer)> record)
+	{
+		auto cached = std::find_if(cachedCommandBuffers.begin(), cachedCommandBuffers.end(), [&](CachedCommandBuffer& entry) { return entry.key == key; });
+		if (cached == cachedCommandBuffers.end())
+		{
+			if (cachedCommandPool == NULL)
+			{
+				//Cached buffers are reset one by one, so they need their own pool that the frame resets do not touch
+				cachedCommandPool = vom.MakeCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer, vom.GetGeneralQueue().index));
+			}
+			CachedCommandBuffer entry;
+			entry.key = key;
+			vk::CommandBufferAllocateInfo allocateInfo(cachedCommandPool, vk::CommandBufferLevel::ePrimary, 1);
+			auto res = vom.GetDevice().allocateCommandBuffers(&allocateInfo, &entry.cmd);
+			cachedCommandBuffers.emplace_back(entry);
+			cached = cachedCommandBuffers.end() - 1;
+		}
+		if (!cached->recorded || cached->version != version)
+		{
+			if (cached->lastSubmitValue != 0)
+			{
+				vk::SemaphoreWaitInfo waitInfo({}, 1, &syncManager.signalSemaphores.semaphores[0], &cached->lastSubmitValue);
+				auto res = vom.GetDevice().waitSemaphores(waitInfo, UINT64_MAX);
+			}
+			cached->cmd.reset();
+			cached->cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eSimultaneousUse));
+			record(cached->cmd);
+			cached->cmd.end();
+			cached->version = version;
+			cached->recorded = true;
+		}
+		cmdCache.AddUsedBuffers({ cached->cmd });
+		return cached->cmd;
+	}
+	void CommandManager::Invalidate(uint64_t key)
+	{
+		for (auto& cached : cachedCommandBuffers)
+		{
+			if (cached.key == key)
+			{
+				cached.recorded = false;
+			}
+		}
+	}
+	void CommandManager::InvalidateAll()
+	{
+		for (auto& cached : cachedCommandBuffers)
+		{
+			cached.recorded = false;
+		}
+	}
+	void CommandManager::DependsOn(const std::vector<WaitData>& waits)
 	{
 		syncManager.AttachWaitData(waits);
 	}
 	void CommandManager::DependsOn(std::vector<CommandManager*> managers)
 	{
-		std::vector<WaitData> waits;
 		for (auto manager : managers)
 		{
 			auto signal = manager->GetMainTimelineSignal();
-			waits.emplace_back(WaitData(signal.signalValue, signal.semaphore, manager->targetStages));
+			syncManager.AttachWaitData(WaitData(signal.signalValue, signal.semaphore, manager->targetStages));
+		}
+	}
+	void CommandManager::DependsOn(const SemaphoreWaits& waits)
+	{
+		for (auto& wait : waits)
+		{
+			syncManager.AttachWait(wait);
+		}
+	}
+	void CommandManager::DependsOnNext(const SemaphoreWaits& waits)
+	{
+		for (auto& wait : waits)
+		{
+			syncManager.AttachNextWait(wait);
 		}
-		DependsOn(waits);
 	}
 	void CommandManager::ClearDepends()
 	{
@@ -91,35 +154,84 @@ namespace vkt
 		cmdCache.AddFreeBuffers(buffers);
 	}
 
-	vk::SubmitInfo CommandManager::GetSubmitInfo(bool incrementSubmitCount, bool withNormalWaits, bool withNormalSignals)
+	void CommandManager::EnableProfiling(float timestampPeriod, uint32_t maxZones, uint32_t framesInFlight)
+	{
+		profiler = TimestampProfiler(vom, syncManager.signalSemaphores.semaphores[0], timestampPeriod, maxZones, framesInFlight);
+	}
+	bool CommandManager::ProfilingEnabled()
+	{
+		return profiler.Enabled();
+	}
+	void CommandManager::BeginZone(vk::CommandBuffer cmd, std::string name)
+	{
+		profiler.BeginZone(cmd, name);
+	}
+	void CommandManager::EndZone(vk::CommandBuffer cmd)
+	{
+		profiler.EndZone(cmd);
+	}
+	std::vector<ZoneStatistics> CommandManager::GetZoneStatistics()
+	{
+		return profiler.GetStatistics();
+	}
+	void CommandManager::EnablePipelineStatistics(vk::QueryPipelineStatisticFlags statistics, uint32_t maxZones, uint32_t framesInFlight)
+	{
+		statisticsProfiler = PipelineStatisticsProfiler(vom, syncManager.signalSemaphores.semaphores[0], statistics, maxZones, framesInFlight);
+	}
+	bool CommandManager::PipelineStatisticsEnabled()
+	{
+		return statisticsProfiler.Enabled();
+	}
+	void CommandManager::BeginStatistics(vk::CommandBuffer cmd, std::string name, uint64_t objectCount)
+	{
+		statisticsProfiler.BeginZone(cmd, name, objectCount);
+	}
+	void CommandManager::EndStatistics(vk::CommandBuffer cmd)
+	{
+		statisticsProfiler.EndZone(cmd);
+	}
+	std::vector<PipelineStatisticsReport> CommandManager::GetPipelineStatistics()
+	{
+		return statisticsProfiler.GetReports();
+	}
+
+	vk::SubmitInfo2 CommandManager::GetSubmitInfo(bool incrementSubmitCount, bool withNormalWaits, bool withNormalSignals)
 	{
 		if (incrementSubmitCount)
 		{
-			(*submitCount)++;
+			IncrementSubmitCount();
+		}
+		profiler.Resolve();
+		profiler.EndFrame(GetSubmitCount());
+		statisticsProfiler.Resolve();
+		statisticsProfiler.EndFrame(GetSubmitCount());
+		syncManager.GetWaitSubmitInfos(waitInfos, withNormalWaits);
+		syncManager.GetSignalSubmitInfos(signalInfos, withNormalSignals);
+		commandBufferInfos.clear();
+		for (auto& cmd : *cmdCache.usedCommandBuffers)
+		{
+			commandBufferInfos.emplace_back(vk::CommandBufferSubmitInfo(cmd));
 		}
-		auto timelineSubmitInfoPtr = syncManager.GetTimelineSubmitInfoPtr(withNormalWaits, withNormalSignals);
-		submitInfo = vk::SubmitInfo(timelineSubmitInfoPtr->waitSemaphoreValueCount, syncManager.waitSemaphores.semaphores.data(),
-			syncManager.waitSemaphores.waitStages.data(),
-			cmdCache.usedCommandBuffers->size(), cmdCache.usedCommandBuffers->data(), timelineSubmitInfoPtr->signalSemaphoreValueCount,
-			syncManager.signalSemaphores.semaphores.data());
-		submitInfo.pNext = timelineSubmitInfoPtr;
+		for (auto& cached : cachedCommandBuffers)
+		{
+			if (std::find(cmdCache.usedCommandBuffers->begin(), cmdCache.usedCommandBuffers->end(), cached.cmd) != cmdCache.usedCommandBuffers->end())
+			{
+				cached.lastSubmitValue = GetSubmitCount();
+			}
+		}
+		submitInfo = vk::SubmitInfo2({}, waitInfos.size(), waitInfos.data(), commandBufferInfos.size(), commandBufferInfos.data(), signalInfos.size(), signalInfos.data());
 
 		return submitInfo;
 	}
 	void CommandManager::Execute(bool incrementSubmitCount, bool wait, bool useNormalSignal, bool withNormalWaits)
 	{
-		if (incrementSubmitCount)
+		GetSubmitInfo(incrementSubmitCount, withNormalWaits, useNormalSignal);
+
+		vk::Result res;
 		{
-			(*submitCount)++;
+			std::lock_guard<std::mutex> lock(QueueMutex(vom.GetGeneralQueue().queue));
+			res = vom.GetGeneralQueue().queue.submit2(1, &submitInfo, (wait) ? fence : VK_NULL_HANDLE);
 		}
-		auto timelineSubmitInfoPtr = syncManager.GetTimelineSubmitInfoPtr(withNormalWaits, useNormalSignal);
-		submitInfo = vk::SubmitInfo(syncManager.waitSemaphores.size(), syncManager.waitSemaphores.semaphores.data(),
-			syncManager.waitSemaphores.waitStages.data(),
-			cmdCache.usedCommandBuffers->size(), cmdCache.usedCommandBuffers->data(), timelineSubmitInfoPtr->signalSemaphoreValueCount,
-			syncManager.signalSemaphores.semaphores.data());
-		submitInfo.pNext = timelineSubmitInfoPtr;
-
-		auto res = vom.GetGeneralQueue().queue.submit(1, &submitInfo, (wait) ? fence : VK_NULL_HANDLE);
 		if (wait)
 		{
 			res = vom.GetDevice().waitForFences(1, &fence, VK_TRUE, UINT64_MAX);
@@ -127,9 +239,22 @@ namespace vkt
 		}
 
 	}
+	void CommandManager::Execute(SubmissionBatcher& batcher, bool incrementSubmitCount, bool useNormalSignal, bool withNormalWaits)
+	{
+		GetSubmitInfo(incrementSubmitCount, withNormalWaits, useNormalSignal);
+		batcher.Add(vom.GetGeneralQueue(), waitInfos, commandBufferInfos, signalInfos);
+	}
+	void CommandManager::Execute(SubmissionThread& thread, bool incrementSubmitCount, bool useNormalSignal, bool withNormalWaits)
+	{
+		assert(thread.GetQueue().queue == vom.GetGeneralQueue().queue);
+		GetSubmitInfo(incrementSubmitCount, withNormalWaits, useNormalSignal);
+		thread.Enqueue(waitInfos, commandBufferInfos, signalInfos);
+	}
 	bool CommandManager::IsFinished()
 	{
-		vk::SemaphoreWaitInfo waitInfo({}, 1, &syncManager.signalSemaphores.semaphores[0], submitCount.get());
+		//Submitting threads change the count through atomic_ref, so it is loaded once instead of handing the shared value to vulkan
+		uint64_t value = GetSubmitCount();
+		vk::SemaphoreWaitInfo waitInfo({}, 1, &syncManager.signalSemaphores.semaphores[0], &value);
 		if (vom.GetDevice().waitSemaphores(waitInfo, 0) == vk::Result::eSuccess)
 		{
 			return true;
@@ -138,11 +263,17 @@ namespace vkt
 	}
 	void CommandManager::Wait()
 	{
-		vk::SemaphoreWaitInfo waitInfo({}, 1, &syncManager.signalSemaphores.semaphores[0], submitCount.get());
+		uint64_t value = GetSubmitCount();
+		vk::SemaphoreWaitInfo waitInfo({}, 1, &syncManager.signalSemaphores.semaphores[0], &value);
 		auto res = vom.GetDevice().waitSemaphores(waitInfo, UINT64_MAX);
 	}
 	void CommandManager::Reset()
 	{
+		//Cached buffers live in their own pool and must not end up in the free list
+		for (auto& cached : cachedCommandBuffers)
+		{
+			std::erase(*cmdCache.usedCommandBuffers, cached.cmd);
+		}
 		if (externalCommandPool == NULL)
 		{
 			cmdCache.ResetCommandPool();
@@ -154,7 +285,7 @@ namespace vkt
 	}
 	uint64_t CommandManager::GetSubmitCount()
 	{
-		return *submitCount;
+		return std::atomic_ref<uint64_t>(*submitCount).load(std::memory_order_acquire);
 	}
 	std::shared_ptr<uint64_t> CommandManager::GetSubmitCountPtr()
 	{
@@ -163,7 +294,8 @@ namespace vkt
 
 	void CommandManager::IncrementSubmitCount()
 	{
-		(*submitCount)++;
+		//Other threads read the count when they build submissions that wait on this manager
+		std::atomic_ref<uint64_t>(*submitCount).fetch_add(1, std::memory_order_acq_rel);
 	}
 	SemaphoreDataEntity CommandManager::GetMainTimelineSignal()
 	{
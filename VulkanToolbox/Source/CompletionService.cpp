@@ -0,0 +1,124 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	CompletionService::CompletionService(ObjectManager& _vom)
+		: vom(_vom)
+	{
+		Start();
+	}
+	CompletionService::CompletionService(vk::Device deviceHandle)
+		: vom(deviceHandle)
+	{
+		Start();
+	}
+	CompletionService::~CompletionService()
+	{
+		Stop();
+	}
+
+	void CompletionService::OnComplete(vk::Semaphore semaphore, uint64_t value, std::function<void()> callback)
+	{
+		assert(semaphore != NULL);
+		{
+			std::lock_guard<std::mutex> lock(pendingMutex);
+			pending.emplace_back(CompletionCallback{ semaphore, value, callback });
+		}
+		Wake();
+	}
+	void CompletionService::OnComplete(CommandManager& manager, std::function<void()> callback)
+	{
+		OnComplete(manager.GetMainTimelineSignal().semaphore, manager.GetSubmitCount(), callback);
+	}
+	void CompletionService::Stop()
+	{
+		if (!running)
+		{
+			return;
+		}
+		running = false;
+		Wake();
+		worker.join();
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		pending.clear();
+	}
+	uint64_t CompletionService::PendingCount()
+	{
+		std::lock_guard<std::mutex> lock(pendingMutex);
+		return pending.size();
+	}
+
+	void CompletionService::Start()
+	{
+		wakeSemaphore = vom.MakeTimelineSemaphore(0);
+		running = true;
+		worker = std::thread(&CompletionService::Run, this);
+	}
+	void CompletionService::Wake()
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		vk::SemaphoreSignalInfo signalInfo(wakeSemaphore, ++wakeValue);
+		auto res = vom.GetDevice().signalSemaphore(signalInfo);
+	}
+	void CompletionService::Run()
+	{
+		std::vector<vk::Semaphore> semaphores;
+		std::vector<uint64_t> values;
+		std::vector<std::function<void()>> ready;
+		uint64_t observedWake = 0;
+		while (running)
+		{
+			//Every semaphore is waited on once with the smallest pending value, the wake semaphore interrupts the wait for new registrations
+			semaphores.clear();
+			values.clear();
+			semaphores.emplace_back(wakeSemaphore);
+			values.emplace_back(observedWake + 1);
+			{
+				std::lock_guard<std::mutex> lock(pendingMutex);
+				for (auto& entry : pending)
+				{
+					auto found = std::find(semaphores.begin(), semaphores.end(), entry.semaphore);
+					if (found == semaphores.end())
+					{
+						semaphores.emplace_back(entry.semaphore);
+						values.emplace_back(entry.value);
+					}
+					else
+					{
+						auto& value = values[found - semaphores.begin()];
+						value = (std::min)(value, entry.value);
+					}
+				}
+			}
+			vk::SemaphoreWaitInfo waitInfo(vk::SemaphoreWaitFlagBits::eAny, semaphores.size(), semaphores.data(), values.data());
+			auto res = vom.GetDevice().waitSemaphores(waitInfo, UINT64_MAX);
+			observedWake = vom.GetDevice().getSemaphoreCounterValue(wakeSemaphore);
+
+			ready.clear();
+			{
+				std::lock_guard<std::mutex> lock(pendingMutex);
+				for (uint64_t i = 1; i < semaphores.size(); i++)
+				{
+					uint64_t reached = vom.GetDevice().getSemaphoreCounterValue(semaphores[i]);
+					for (uint64_t j = 0; j < pending.size();)
+					{
+						if (pending[j].semaphore == semaphores[i] && pending[j].value <= reached)
+						{
+							ready.emplace_back(std::move(pending[j].callback));
+							pending[j] = std::move(pending.back());
+							pending.pop_back();
+						}
+						else
+						{
+							j++;
+						}
+					}
+				}
+			}
+			for (auto& callback : ready)
+			{
+				callback();
+			}
+		}
+	}
+}
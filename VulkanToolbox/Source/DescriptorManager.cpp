@@ -117,26 +117,40 @@ namespace vkt
 
 	bool DescriptorSetData::NeedsRewrite()
 	{
-		for (size_t i = 0; i < descData.size(); i++)
+		for (auto& group : versionGroups)
 		{
-			if (descData.versions[i] != *descData.srcVersions[i])
+			if (group.version != std::atomic_ref<uint64_t>(*group.srcVersion).load(std::memory_order_acquire))
 			{
 				return true;
 			}
 		}
 		return false;
 	}
+	static void AddToVersionGroup(std::vector<DescriptorVersionGroup>& versionGroups, std::shared_ptr<uint64_t>& srcVersion, uint32_t binding)
+	{
+		auto group = std::find_if(versionGroups.begin(), versionGroups.end(), [&srcVersion](DescriptorVersionGroup& known) { return known.srcVersion == srcVersion; });
+		if (group == versionGroups.end())
+		{
+			versionGroups.emplace_back(DescriptorVersionGroup{ srcVersion });
+			group = versionGroups.end() - 1;
+		}
+		//The group has to look at its bindings again so the new one gets written
+		group->version = UINT64_MAX;
+		group->bindings.emplace_back(binding);
+	}
 	bool DescriptorSetData::NeedsAllocation()
 	{
-		return set == NULL || layoutBindingCount != descData.size();
+		return layout == NULL || layoutBindingCount != descData.size();
 	}
 	void DescriptorSetData::AddDescriptor(vk::DescriptorType type, std::shared_ptr<uint64_t> srcVersion, vk::ShaderStageFlags targetStage, vk::Buffer* buffer, uint64_t* offset, uint64_t* range)
 	{
 		descData.EmplaceBack(type, srcVersion, targetStage, buffer, offset, range, nullptr, nullptr, nullptr);
+		AddToVersionGroup(versionGroups, srcVersion, descData.size() - 1);
 	}
 	void DescriptorSetData::AddDescriptor(vk::DescriptorType type, std::shared_ptr<uint64_t> srcVersion, vk::ShaderStageFlags targetStage, vk::ImageLayout* layout, vk::ImageView* view, vk::Sampler* sampler)
 	{
 		descData.EmplaceBack(type, srcVersion, targetStage, nullptr, nullptr, nullptr, layout, view, sampler);
+		AddToVersionGroup(versionGroups, srcVersion, descData.size() - 1);
 	}
 	void DescriptorSetData::AttachSector(std::shared_ptr<SectorData> sector, vk::ShaderStageFlags targetStage)
 	{
@@ -190,73 +204,528 @@ namespace vkt
 		}
 		return vk::DescriptorSetLayoutCreateInfo({}, bindings.size(), bindings.data());
 	}
-	std::vector<vk::WriteDescriptorSet>& DescriptorSetData::Write()
+	void DescriptorSetData::Write(std::vector<vk::WriteDescriptorSet>& writes)
+	{
+		for (auto& group : versionGroups)
+		{
+			uint64_t srcVersion = std::atomic_ref<uint64_t>(*group.srcVersion).load(std::memory_order_acquire);
+			if (group.version == srcVersion)
+			{
+				continue;
+			}
+			group.version = srcVersion;
+			for (auto i : group.bindings)
+			{
+				//A moved source version does not mean the binding moved, only bindings with a new buffer range or image are written
+				bool written = descData.versions[i] != UINT64_MAX;
+				descData.versions[i] = srcVersion;
+				auto desc = descData[i];
+				if (desc.IsBufferDescriptor())
+				{
+					vk::DescriptorBufferInfo bInfo(*desc.buffer, *desc.allocationOffset, *desc.range);
+					if (written && bInfo == desc.bInfo)
+					{
+						continue;
+					}
+					auto buffDesc = desc.AsBufferDescriptor();
+					writes.emplace_back(vk::WriteDescriptorSet(set, i, 0, 1, buffDesc.type, {}, &buffDesc.bInfo, {}));
+				}
+				else if (desc.IsImageDescriptor())
+				{
+					vk::DescriptorImageInfo iInfo(*desc.sampler, *desc.view, *desc.imageLayout);
+					if (written && iInfo == desc.iInfo)
+					{
+						continue;
+					}
+					auto imgDesc = desc.AsImageDescriptor();
+					writes.emplace_back(vk::WriteDescriptorSet(set, i, 0, 1, imgDesc.type, &imgDesc.iInfo, {}, {}));
+				}
+			}
+		}
+	}
+	void DescriptorSetData::Invalidate()
+	{
+		for (auto& version : descData.versions)
+		{
+			version = UINT64_MAX;
+		}
+		for (auto& group : versionGroups)
+		{
+			group.version = UINT64_MAX;
+		}
+	}
+	void DescriptorSetData::ProduceTemplateEntries(std::vector<vk::DescriptorUpdateTemplateEntry>& entries)
 	{
-		writes.resize(descData.size());
-		writes.clear();
 		for (size_t i = 0; i < descData.size(); i++)
 		{
-			auto desc = descData[i];
-			desc.version = *desc.srcVersion;
-			if (desc.IsBufferDescriptor())
+			entries.emplace_back(vk::DescriptorUpdateTemplateEntry(i, 0, 1, descData.types[i], i * DescriptorTemplateStride, DescriptorTemplateStride));
+		}
+	}
+	const void* DescriptorSetData::GatherTemplateData()
+	{
+		templateData.resize(descData.size() * DescriptorTemplateStride);
+		for (size_t i = 0; i < descData.size(); i++)
+		{
+			uint8_t* record = templateData.data() + i * DescriptorTemplateStride;
+			if (descData.buffers[i] != nullptr)
+			{
+				vk::DescriptorBufferInfo bInfo(*descData.buffers[i], *descData.allocationOffsets[i], *descData.ranges[i]);
+				memcpy(record, &bInfo, sizeof(bInfo));
+			}
+			else if (descData.views[i] != nullptr)
+			{
+				vk::DescriptorImageInfo iInfo(*descData.samplers[i], *descData.views[i], *descData.imageLayouts[i]);
+				memcpy(record, &iInfo, sizeof(iInfo));
+			}
+		}
+		return templateData.data();
+	}
+	DescriptorPoolChain::DescriptorPoolChain(ObjectManager& _vom, uint32_t _setsPerPool) : vom(_vom), setsPerPool(_setsPerPool) {}
+	DescriptorPoolChain::DescriptorPoolChain(vk::Device deviceHandle, uint32_t _setsPerPool) : vom(deviceHandle), setsPerPool(_setsPerPool) {}
+
+	DescriptorAllocation DescriptorPoolChain::Allocate(vk::DescriptorSetLayout layout, const std::vector<vk::DescriptorPoolSize>& typeCounts)
+	{
+		Collect();
+		bool newTypes = false;
+		for (auto& count : typeCounts)
+		{
+			auto found = std::find_if(setTypeCounts.begin(), setTypeCounts.end(), [&count](vk::DescriptorPoolSize& known) { return known.type == count.type; });
+			if (found == setTypeCounts.end())
+			{
+				setTypeCounts.emplace_back(count);
+				newTypes = true;
+			}
+			else if (found->descriptorCount < count.descriptorCount)
+			{
+				found->descriptorCount = count.descriptorCount;
+				newTypes = true;
+			}
+		}
+		//The older pools can not hold the new counts but are not full either, so the new pool keeps their size
+		if (newTypes || pools.empty())
+		{
+			AddPool(false);
+		}
+
+		vk::DescriptorSet set;
+		vk::DescriptorSetAllocateInfo allocateInfo({}, 1, &layout);
+		//The newest pools are tried first, older ones only have room where sets were freed
+		for (size_t i = pools.size(); i > 0; i--)
+		{
+			auto& pool = pools[i - 1];
+			if (pool.allocatedSets == pool.maxSets)
 			{
-				auto buffDesc = desc.AsBufferDescriptor();
-				writes.emplace_back(vk::WriteDescriptorSet(set, buffDesc.index, 0, 1, buffDesc.type, {}, &buffDesc.bInfo, {}));
+				continue;
 			}
-			else if (desc.IsImageDescriptor())
+			allocateInfo.descriptorPool = pool.pool;
+			if (vom.GetDevice().allocateDescriptorSets(&allocateInfo, &set) == vk::Result::eSuccess)
 			{
-				auto imgDesc = desc.AsImageDescriptor();
-				writes.emplace_back(vk::WriteDescriptorSet(set, imgDesc.index, 0, 1, imgDesc.type, &imgDesc.iInfo, {}, {}));
+				pool.allocatedSets++;
+				return DescriptorAllocation{ set, pool.pool };
 			}
 		}
-		return writes;
+		//Every pool is out of sets or descriptors, only now the chain grows
+		AddPool(true);
+		allocateInfo.descriptorPool = pools.back().pool;
+		auto res = vom.GetDevice().allocateDescriptorSets(&allocateInfo, &set);
+		assert(res == vk::Result::eSuccess);
+		pools.back().allocatedSets++;
+		return DescriptorAllocation{ set, pools.back().pool };
+	}
+	void DescriptorPoolChain::Free(DescriptorAllocation allocation)
+	{
+		auto pool = std::find_if(pools.begin(), pools.end(), [&allocation](DescriptorPoolData& data) { return data.pool == allocation.pool; });
+		assert(pool != pools.end());
+		auto res = vom.GetDevice().freeDescriptorSets(allocation.pool, 1, &allocation.set);
+		pool->allocatedSets--;
+	}
+	void DescriptorPoolChain::Free(DescriptorAllocation allocation, vk::Semaphore semaphore, uint64_t value)
+	{
+		pendingFrees.emplace_back(PendingDescriptorFree{ allocation, semaphore, value });
+	}
+	void DescriptorPoolChain::Collect()
+	{
+		for (size_t i = 0; i < pendingFrees.size();)
+		{
+			if (vom.GetDevice().getSemaphoreCounterValue(pendingFrees[i].semaphore) >= pendingFrees[i].value)
+			{
+				Free(pendingFrees[i].allocation);
+				pendingFrees[i] = pendingFrees.back();
+				pendingFrees.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+	uint64_t DescriptorPoolChain::PoolCount()
+	{
+		return pools.size();
+	}
+	void DescriptorPoolChain::AddPool(bool grow)
+	{
+		uint32_t maxSets = pools.empty() ? setsPerPool : pools.back().maxSets * (grow ? 2 : 1);
+		std::vector<vk::DescriptorPoolSize> poolSizes = setTypeCounts;
+		for (auto& size : poolSizes)
+		{
+			size.descriptorCount *= maxSets;
+		}
+		auto pool = vom.MakeDescriptorPool(vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, maxSets, poolSizes.size(), poolSizes.data()));
+		pools.emplace_back(DescriptorPoolData{ pool, maxSets, 0 });
+	}
 
+	bool DescriptorBufferFunctions::Load(vk::Device device)
+	{
+		getLayoutSize = reinterpret_cast<PFN_vkGetDescriptorSetLayoutSizeEXT>(vkGetDeviceProcAddr(device, "vkGetDescriptorSetLayoutSizeEXT"));
+		getBindingOffset = reinterpret_cast<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(vkGetDeviceProcAddr(device, "vkGetDescriptorSetLayoutBindingOffsetEXT"));
+		getDescriptor = reinterpret_cast<PFN_vkGetDescriptorEXT>(vkGetDeviceProcAddr(device, "vkGetDescriptorEXT"));
+		bindDescriptorBuffers = reinterpret_cast<PFN_vkCmdBindDescriptorBuffersEXT>(vkGetDeviceProcAddr(device, "vkCmdBindDescriptorBuffersEXT"));
+		setDescriptorBufferOffsets = reinterpret_cast<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(vkGetDeviceProcAddr(device, "vkCmdSetDescriptorBufferOffsetsEXT"));
+		return Available();
 	}
-	DescriptorManager::DescriptorManager(ObjectManager& _vom) : vom(_vom) {}
-	DescriptorManager::DescriptorManager(vk::Device device) : vom(device) {}
+	bool DescriptorBufferFunctions::Available()
+	{
+		return getLayoutSize != nullptr && getBindingOffset != nullptr && getDescriptor != nullptr && bindDescriptorBuffers != nullptr && setDescriptorBufferOffsets != nullptr;
+	}
+
+	DescriptorManager::DescriptorManager(ObjectManager& _vom, DescriptorBackend _backend, uint64_t _descriptorBufferSize) : vom(_vom), pools(_vom)
+	{
+		if (_backend == DescriptorBackend::DescriptorBuffer && SetupDescriptorBuffer(_vom, _descriptorBufferSize))
+		{
+			backend = DescriptorBackend::DescriptorBuffer;
+		}
+	}
+	DescriptorManager::DescriptorManager(vk::Device device) : vom(device), pools(device) {}
 	std::shared_ptr<DescriptorSetData> DescriptorManager::GetNewSet()
 	{
 		sets.emplace_back(std::make_shared<DescriptorSetData>());
 		return sets.back();
 	}
-	void DescriptorManager::Update()
+	bool DescriptorManager::Update()
 	{
+		bool placedAll = true;
 		//Allocation Pass
-		for (auto setData : sets)
+		for (auto& setData : sets)
 		{
 			if (setData->NeedsAllocation())
 			{
-				vom.DestroyType(vk::DescriptorPool());
-				vom.DestroyType(vk::DescriptorSetLayout());
-				std::vector<vk::DescriptorPoolSize> typeCounts;
-				std::vector<vk::DescriptorSetLayout> layouts;
-				for (auto& set : sets)
+				if (setData->layout != NULL)
 				{
-					set->layout = vom.MakeDescriptorSetLayout(set->ProduceSetLayout());
-					layouts.emplace_back(set->layout);
-					set->ProduceTypeCounts(typeCounts);
-					set->layoutBindingCount = set->descData.size();
+					Release(*setData);
 				}
-				mainPool = vom.MakeDescriptorPool(vk::DescriptorPoolCreateInfo({}, sets.size(), typeCounts.size(), typeCounts.data()));
-				auto newSets = vom.MakeDescriptorSets(vk::DescriptorSetAllocateInfo(mainPool, sets.size(), layouts.data()));
-				for (size_t i = 0; i < sets.size(); i++)
+				auto layoutInfo = setData->ProduceSetLayout();
+				if (backend == DescriptorBackend::DescriptorBuffer)
 				{
-					sets[i]->set = newSets[i];
+					layoutInfo.flags |= vk::DescriptorSetLayoutCreateFlagBits::eDescriptorBufferEXT;
+					setData->layout = vom.MakeDescriptorSetLayout(layoutInfo);
+					if (!PlaceInDescriptorBuffer(*setData))
+					{
+						vom.Destroy(setData->layout);
+						setData->layout = nullptr;
+						placedAll = false;
+						continue;
+					}
 				}
-				break;
+				else
+				{
+					setData->layout = vom.MakeDescriptorSetLayout(layoutInfo);
+					std::vector<vk::DescriptorPoolSize> typeCounts;
+					setData->ProduceTypeCounts(typeCounts);
+					auto allocation = pools.Allocate(setData->layout, typeCounts);
+					setData->set = allocation.set;
+					setData->pool = allocation.pool;
+				}
+				setData->layoutBindingCount = setData->descData.size();
+				version++;
+				//The new set holds none of the old writes
+				setData->Invalidate();
 			}
 		}
 
 
 		//Write Pass
-		for (auto setData : sets)
+		if (backend == DescriptorBackend::DescriptorBuffer)
 		{
-			if (setData->NeedsRewrite())
+			for (auto& setData : sets)
 			{
-				auto& write = setData->Write();
-				vom.GetDevice().updateDescriptorSets(write.size(), write.data(), 0, {});
-
+				WriteToDescriptorBuffer(*setData);
 			}
+			vmaFlushAllocation(vom.GetAllocator(), descriptorBuffer.allocation, 0, VK_WHOLE_SIZE);
+			return placedAll;
+		}
+		writes.clear();
+		for (auto& setData : sets)
+		{
+			setData->Write(writes);
+		}
+		if (!writes.empty())
+		{
+			vom.GetDevice().updateDescriptorSets(writes.size(), writes.data(), 0, {});
+			version++;
+		}
+		return placedAll;
+	}
+	void DescriptorManager::ReleaseOn(vk::Semaphore semaphore, std::shared_ptr<uint64_t> valuePtr)
+	{
+		releaseSemaphore = semaphore;
+		releaseValue = valuePtr;
+	}
+	void DescriptorManager::Bind(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex, DescriptorSetData& setData)
+	{
+		if (backend == DescriptorBackend::Sets)
+		{
+			cmd.bindDescriptorSets(bindPoint, pipelineLayout, setIndex, 1, &setData.set, 0, {});
+			return;
+		}
+		assert(setData.layout != NULL);
+		VkDescriptorBufferBindingInfoEXT bindingInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT };
+		bindingInfo.address = descriptorAddress;
+		bindingInfo.usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT;
+		bufferFunctions.bindDescriptorBuffers(cmd, 1, &bindingInfo);
+		uint32_t bufferIndex = 0;
+		VkDeviceSize offset = setData.bufferOffset;
+		bufferFunctions.setDescriptorBufferOffsets(cmd, static_cast<VkPipelineBindPoint>(bindPoint), pipelineLayout, setIndex, 1, &bufferIndex, &offset);
+	}
+	DescriptorBackend DescriptorManager::GetBackend()
+	{
+		return backend;
+	}
+	uint64_t DescriptorManager::GetVersion()
+	{
+		return version;
+	}
+	vk::PipelineCreateFlags DescriptorManager::GetPipelineFlags()
+	{
+		if (backend == DescriptorBackend::DescriptorBuffer)
+		{
+			return vk::PipelineCreateFlagBits::eDescriptorBufferEXT;
+		}
+		return {};
+	}
+	void DescriptorManager::Release(DescriptorSetData& setData)
+	{
+		DescriptorAllocation allocation{ setData.set, setData.pool };
+		DescriptorRange range{ setData.bufferOffset, setData.bufferSize };
+		if (releaseSemaphore != VK_NULL_HANDLE)
+		{
+			uint64_t value = std::atomic_ref<uint64_t>(*releaseValue).load(std::memory_order_acquire);
+			if (backend == DescriptorBackend::DescriptorBuffer)
+			{
+				pendingRanges.emplace_back(PendingDescriptorRange{ range, releaseSemaphore, value });
+			}
+			else
+			{
+				pools.Free(allocation, releaseSemaphore, value);
+			}
+			//Layouts from an object cache are not owned by this manager and stay alive
+			if (vom.Owns(setData.layout))
+			{
+				vom.Retire(setData.layout, releaseSemaphore, value);
+			}
+		}
+		else
+		{
+			if (backend == DescriptorBackend::DescriptorBuffer)
+			{
+				FreeRange(range);
+			}
+			else
+			{
+				pools.Free(allocation);
+			}
+			vom.Destroy(setData.layout);
+		}
+		setData.set = nullptr;
+		setData.pool = nullptr;
+		setData.layout = nullptr;
+	}
+	bool DescriptorManager::SetupDescriptorBuffer(ObjectManager& _vom, uint64_t size)
+	{
+		//getBufferAddress is only valid when the device enabled both features and the allocator binds memory with the device address flag
+		auto features = _vom.GetEnabledFeatures();
+		if (!features.descriptorBuffer || !features.bufferDeviceAddress || (_vom.GetAllocatorFlags() & VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT) == 0)
+		{
+			return false;
+		}
+		if (!bufferFunctions.Load(vom.GetDevice()))
+		{
+			return false;
+		}
+		vom.SetPhysicalDevice(_vom.GetPhysicalDevice());
+		vom.SetAllocator(_vom.GetAllocator(), _vom.GetAllocatorFlags());
+		bufferProperties = vom.GetPhysicalDevice().getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceDescriptorBufferPropertiesEXT>().get<vk::PhysicalDeviceDescriptorBufferPropertiesEXT>();
+		MakeDescriptorBuffer((std::min)(size, static_cast<uint64_t>(bufferProperties.maxResourceDescriptorBufferRange)));
+		return true;
+	}
+	void DescriptorManager::MakeDescriptorBuffer(uint64_t size)
+	{
+		descriptorBufferSize = size;
+		VmaAllocationCreateInfo allocationCreateInfo = {};
+		allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+		allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+		descriptorBuffer = vom.VmaMakeBuffer(vk::BufferCreateInfo({}, descriptorBufferSize, vk::BufferUsageFlagBits::eResourceDescriptorBufferEXT | vk::BufferUsageFlagBits::eShaderDeviceAddress), allocationCreateInfo);
+		descriptorMap = static_cast<uint8_t*>(descriptorBuffer.allocationInfo.pMappedData);
+		descriptorAddress = vom.GetDevice().getBufferAddress(vk::BufferDeviceAddressInfo(descriptorBuffer.buffer));
+	}
+	bool DescriptorManager::PlaceInDescriptorBuffer(DescriptorSetData& setData)
+	{
+		VkDeviceSize layoutSize = 0;
+		bufferFunctions.getLayoutSize(vom.GetDevice(), setData.layout, &layoutSize);
+		uint64_t alignment = bufferProperties.descriptorBufferOffsetAlignment;
+		setData.bufferSize = (layoutSize + alignment - 1) / alignment * alignment;
+		setData.bufferOffset = AllocateRange(setData.bufferSize);
+		if (setData.bufferOffset == UINT64_MAX)
+		{
+			setData.bufferOffset = 0;
+			setData.bufferSize = 0;
+			return false;
+		}
+		setData.bindingOffsets.resize(setData.descData.size());
+		for (size_t i = 0; i < setData.descData.size(); i++)
+		{
+			VkDeviceSize bindingOffset = 0;
+			bufferFunctions.getBindingOffset(vom.GetDevice(), setData.layout, i, &bindingOffset);
+			setData.bindingOffsets[i] = bindingOffset;
+		}
+		return true;
+	}
+	bool DescriptorManager::GrowDescriptorBuffer(uint64_t minimumSize)
+	{
+		uint64_t maximumSize = bufferProperties.maxResourceDescriptorBufferRange;
+		if (minimumSize > maximumSize)
+		{
+			return false;
+		}
+		VmaBuffer oldBuffer = descriptorBuffer;
+		uint8_t* oldMap = descriptorMap;
+		MakeDescriptorBuffer((std::min)((std::max)(descriptorBufferSize * 2, minimumSize), maximumSize));
+		memcpy(descriptorMap, oldMap, descriptorBufferUsed);
+		if (releaseSemaphore != VK_NULL_HANDLE)
+		{
+			vom.Retire(oldBuffer, releaseSemaphore, std::atomic_ref<uint64_t>(*releaseValue).load(std::memory_order_acquire));
+		}
+		else
+		{
+			vom.Destroy(oldBuffer);
+		}
+		//Command buffers bound the old buffer's address
+		version++;
+		return true;
+	}
+	void DescriptorManager::WriteToDescriptorBuffer(DescriptorSetData& setData)
+	{
+		if (setData.layout == NULL)
+		{
+			return;
+		}
+		//The set data still decides which bindings changed, their writes are turned into descriptor bytes in place
+		writes.clear();
+		setData.Write(writes);
+		for (auto& write : writes)
+		{
+			uint8_t* destination = descriptorMap + setData.bufferOffset + setData.bindingOffsets[write.dstBinding];
+			VkDescriptorGetInfoEXT getInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT };
+			getInfo.type = static_cast<VkDescriptorType>(write.descriptorType);
+			VkDescriptorAddressInfoEXT addressInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT };
+			size_t descriptorSize = 0;
+			switch (write.descriptorType)
+			{
+			case vk::DescriptorType::eStorageBuffer:
+			case vk::DescriptorType::eUniformBuffer:
+				addressInfo.address = vom.GetDevice().getBufferAddress(vk::BufferDeviceAddressInfo(write.pBufferInfo->buffer)) + write.pBufferInfo->offset;
+				addressInfo.range = write.pBufferInfo->range;
+				if (write.descriptorType == vk::DescriptorType::eStorageBuffer)
+				{
+					getInfo.data.pStorageBuffer = &addressInfo;
+					descriptorSize = bufferProperties.storageBufferDescriptorSize;
+				}
+				else
+				{
+					getInfo.data.pUniformBuffer = &addressInfo;
+					descriptorSize = bufferProperties.uniformBufferDescriptorSize;
+				}
+				break;
+			case vk::DescriptorType::eCombinedImageSampler:
+				getInfo.data.pCombinedImageSampler = reinterpret_cast<const VkDescriptorImageInfo*>(write.pImageInfo);
+				descriptorSize = bufferProperties.combinedImageSamplerDescriptorSize;
+				break;
+			case vk::DescriptorType::eSampledImage:
+				getInfo.data.pSampledImage = reinterpret_cast<const VkDescriptorImageInfo*>(write.pImageInfo);
+				descriptorSize = bufferProperties.sampledImageDescriptorSize;
+				break;
+			case vk::DescriptorType::eStorageImage:
+				getInfo.data.pStorageImage = reinterpret_cast<const VkDescriptorImageInfo*>(write.pImageInfo);
+				descriptorSize = bufferProperties.storageImageDescriptorSize;
+				break;
+			default:
+				//Samplers live in a separate sampler descriptor buffer, which this backend does not make
+				assert(false);
+				continue;
+			}
+			bufferFunctions.getDescriptor(vom.GetDevice(), &getInfo, descriptorSize, destination);
+		}
+	}
+	uint64_t DescriptorManager::AllocateRange(uint64_t size)
+	{
+		for (size_t i = 0; i < pendingRanges.size();)
+		{
+			if (vom.GetDevice().getSemaphoreCounterValue(pendingRanges[i].semaphore) >= pendingRanges[i].value)
+			{
+				FreeRange(pendingRanges[i].range);
+				pendingRanges[i] = pendingRanges.back();
+				pendingRanges.pop_back();
+			}
+			else
+			{
+				i++;
+			}
+		}
+		//Range sizes are multiples of the offset alignment, so what is left of a split range stays aligned
+		for (size_t i = 0; i < freeRanges.size(); i++)
+		{
+			if (freeRanges[i].size >= size)
+			{
+				uint64_t offset = freeRanges[i].offset;
+				freeRanges[i].offset += size;
+				freeRanges[i].size -= size;
+				if (freeRanges[i].size == 0)
+				{
+					freeRanges.erase(freeRanges.begin() + i);
+				}
+				return offset;
+			}
+		}
+		if (descriptorBufferUsed + size > descriptorBufferSize && !GrowDescriptorBuffer(descriptorBufferUsed + size))
+		{
+			return UINT64_MAX;
+		}
+		uint64_t offset = descriptorBufferUsed;
+		descriptorBufferUsed += size;
+		return offset;
+	}
+	void DescriptorManager::FreeRange(DescriptorRange range)
+	{
+		if (range.size == 0)
+		{
+			return;
+		}
+		auto next = std::lower_bound(freeRanges.begin(), freeRanges.end(), range.offset, [](const DescriptorRange& known, uint64_t offset) { return known.offset < offset; });
+		auto inserted = freeRanges.insert(next, range);
+		if (inserted + 1 != freeRanges.end() && inserted->offset + inserted->size == (inserted + 1)->offset)
+		{
+			inserted->size += (inserted + 1)->size;
+			freeRanges.erase(inserted + 1);
+		}
+		if (inserted != freeRanges.begin() && (inserted - 1)->offset + (inserted - 1)->size == inserted->offset)
+		{
+			(inserted - 1)->size += inserted->size;
+			inserted = freeRanges.erase(inserted) - 1;
+		}
+		if (inserted->offset + inserted->size == descriptorBufferUsed)
+		{
+			descriptorBufferUsed = inserted->offset;
+			freeRanges.erase(inserted);
 		}
 	}
 }
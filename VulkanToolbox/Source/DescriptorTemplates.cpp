@@ -0,0 +1,95 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	bool PushDescriptorFunctions::Load(vk::Device device)
+	{
+		pushDescriptorSet = reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetKHR"));
+		pushDescriptorSetWithTemplate = reinterpret_cast<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetWithTemplateKHR"));
+		return Available();
+	}
+	bool PushDescriptorFunctions::Available()
+	{
+		return pushDescriptorSet != nullptr && pushDescriptorSetWithTemplate != nullptr;
+	}
+
+	DescriptorUpdateTemplate::DescriptorUpdateTemplate(ObjectManager& _vom, std::shared_ptr<DescriptorSetData> _setData) : vom(_vom), setData(_setData)
+	{
+		assert(setData->layout != VK_NULL_HANDLE);
+		std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+		setData->ProduceTemplateEntries(entries);
+		updateTemplate = vom.MakeDescriptorUpdateTemplate(vk::DescriptorUpdateTemplateCreateInfo({}, entries.size(), entries.data(), vk::DescriptorUpdateTemplateType::eDescriptorSet, setData->layout));
+	}
+	void DescriptorUpdateTemplate::Update(vk::DescriptorSet set)
+	{
+		if (set == VK_NULL_HANDLE)
+		{
+			set = setData->set;
+		}
+		vom.GetDevice().updateDescriptorSetWithTemplate(set, updateTemplate, setData->GatherTemplateData());
+	}
+
+	PushDescriptorSet::PushDescriptorSet(ObjectManager& _vom, std::shared_ptr<DescriptorSetData> _setData) : vom(_vom), setData(_setData)
+	{
+		functions.Load(vom.GetDevice());
+		auto layoutInfo = setData->ProduceSetLayout();
+		layoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR;
+		if (Available())
+		{
+			layout = vom.MakeDescriptorSetLayout(layoutInfo);
+		}
+	}
+	bool PushDescriptorSet::Available()
+	{
+		return functions.Available();
+	}
+	vk::DescriptorSetLayout PushDescriptorSet::GetLayout()
+	{
+		return layout;
+	}
+	void PushDescriptorSet::PrepareTemplate(vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex)
+	{
+		assert(Available());
+		if (updateTemplate != VK_NULL_HANDLE && templateLayout == pipelineLayout && templateSet == setIndex)
+		{
+			return;
+		}
+		vom.Destroy(updateTemplate);
+		std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+		setData->ProduceTemplateEntries(entries);
+		updateTemplate = vom.MakeDescriptorUpdateTemplate(vk::DescriptorUpdateTemplateCreateInfo({}, entries.size(), entries.data(), vk::DescriptorUpdateTemplateType::ePushDescriptorsKHR, layout, bindPoint, pipelineLayout, setIndex));
+		templateLayout = pipelineLayout;
+		templateSet = setIndex;
+	}
+	void PushDescriptorSet::Push(vk::CommandBuffer cmd)
+	{
+		assert(updateTemplate != VK_NULL_HANDLE);
+		functions.pushDescriptorSetWithTemplate(cmd, updateTemplate, templateLayout, templateSet, setData->GatherTemplateData());
+	}
+	void PushDescriptorSet::Push(vk::CommandBuffer cmd, vk::PipelineBindPoint bindPoint, vk::PipelineLayout pipelineLayout, uint32_t setIndex)
+	{
+		assert(Available());
+		//Every binding is pushed, the writes are built straight from the descriptors so the versions of the set data stay untouched for its own set
+		auto& descData = setData->descData;
+		writes.clear();
+		bufferInfos.clear();
+		imageInfos.clear();
+		//The writes point into the infos, so those must not reallocate while they are filled
+		bufferInfos.reserve(descData.size());
+		imageInfos.reserve(descData.size());
+		for (uint32_t i = 0; i < descData.size(); i++)
+		{
+			if (descData.buffers[i] != nullptr)
+			{
+				bufferInfos.emplace_back(*descData.buffers[i], *descData.allocationOffsets[i], *descData.ranges[i]);
+				writes.emplace_back(vk::WriteDescriptorSet({}, i, 0, 1, descData.types[i], {}, &bufferInfos.back(), {}));
+			}
+			else if (descData.views[i] != nullptr)
+			{
+				imageInfos.emplace_back(*descData.samplers[i], *descData.views[i], *descData.imageLayouts[i]);
+				writes.emplace_back(vk::WriteDescriptorSet({}, i, 0, 1, descData.types[i], &imageInfos.back(), {}, {}));
+			}
+		}
+		functions.pushDescriptorSet(cmd, static_cast<VkPipelineBindPoint>(bindPoint), pipelineLayout, setIndex, writes.size(), reinterpret_cast<const VkWriteDescriptorSet*>(writes.data()));
+	}
+}
@@ -0,0 +1,609 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	FramePass::FramePass(std::string _name, CommandManager* _manager, std::function<void(vk::CommandBuffer)> _record)
+		: name(_name), manager(_manager), record(_record)
+	{
+		assert(manager != nullptr);
+	}
+	FramePass& FramePass::Reads(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access, vk::ImageLayout layout)
+	{
+		for (auto& usage : usages)
+		{
+			if (usage.resource == resource)
+			{
+				assert(layout == vk::ImageLayout::eUndefined || usage.layout == vk::ImageLayout::eUndefined || usage.layout == layout);
+				usage.stages |= stages;
+				usage.access |= access;
+				usage.layout = (layout == vk::ImageLayout::eUndefined) ? usage.layout : layout;
+				return *this;
+			}
+		}
+		usages.emplace_back(FrameResourceUsage{ resource, stages, access, layout, false });
+		return *this;
+	}
+	FramePass& FramePass::Writes(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access, vk::ImageLayout layout)
+	{
+		Reads(resource, stages, access, layout);
+		for (auto& usage : usages)
+		{
+			if (usage.resource == resource)
+			{
+				usage.write = true;
+			}
+		}
+		return *this;
+	}
+	FramePass& FramePass::ReadsIndirect(uint32_t resource)
+	{
+		return Reads(resource, vk::PipelineStageFlagBits2::eDrawIndirect, vk::AccessFlagBits2::eIndirectCommandRead);
+	}
+	FramePass& FramePass::HasSideEffects()
+	{
+		sideEffects = true;
+		return *this;
+	}
+	FramePass& FramePass::Cached(uint64_t key, uint64_t version)
+	{
+		cached = true;
+		cacheKey = key;
+		cacheVersion = version;
+		return *this;
+	}
+	FramePass& FramePass::CollectStatistics(uint64_t objectCount)
+	{
+		collectStatistics = true;
+		statisticsObjectCount = objectCount;
+		return *this;
+	}
+
+	uint32_t FrameGraph::ImportSector(std::shared_ptr<SectorData> sector)
+	{
+		assert(sector != nullptr);
+		compiled = false;
+		FrameResource resource;
+		resource.sector = sector;
+		resources.emplace_back(resource);
+		return resources.size() - 1;
+	}
+	uint32_t FrameGraph::ImportImage(VmaImage image, vk::ImageLayout initialLayout, vk::ImageLayout finalLayout, vk::ImageAspectFlags aspect)
+	{
+		compiled = false;
+		FrameResource resource;
+		resource.image = image;
+		resource.isImage = true;
+		resource.subresourceRange = vk::ImageSubresourceRange(aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS);
+		resource.initialLayout = initialLayout;
+		resource.finalLayout = finalLayout;
+		resources.emplace_back(resource);
+		return resources.size() - 1;
+	}
+	void FrameGraph::SetInitialUsage(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access)
+	{
+		assert(resource < resources.size());
+		compiled = false;
+		resources[resource].initialStages = stages;
+		resources[resource].initialAccess = access;
+	}
+	void FrameGraph::SetFinalUsage(uint32_t resource, vk::PipelineStageFlags2 stages, vk::AccessFlags2 access)
+	{
+		assert(resource < resources.size());
+		compiled = false;
+		resources[resource].finalStages = stages;
+		resources[resource].finalAccess = access;
+	}
+	void FrameGraph::MarkOutput(uint32_t resource)
+	{
+		assert(resource < resources.size());
+		compiled = false;
+		resources[resource].output = true;
+	}
+	FramePass& FrameGraph::AddPass(std::string name, CommandManager* manager, std::function<void(vk::CommandBuffer)> record)
+	{
+		compiled = false;
+		passes.emplace_back(name, manager, record);
+		return passes.back();
+	}
+	void FrameGraph::UseNormalSignal(CommandManager* manager)
+	{
+		if (std::find(normalSignalManagers.begin(), normalSignalManagers.end(), manager) == normalSignalManagers.end())
+		{
+			normalSignalManagers.emplace_back(manager);
+		}
+	}
+
+	bool FrameGraph::Compile()
+	{
+		compiled = false;
+		CullPasses();
+		SortPasses();
+		if (!SortManagers())
+		{
+			return false;
+		}
+		ComputeBarriers();
+		compiled = true;
+		return true;
+	}
+	void FrameGraph::Execute(SubmissionBatcher& batcher)
+	{
+		assert(compiled);
+		if (!compiled)
+		{
+			return;
+		}
+		std::vector<vk::BufferMemoryBarrier2> bufferBarriers;
+		std::vector<vk::ImageMemoryBarrier2> imageBarriers;
+		auto recordBarriers = [&](vk::CommandBuffer cmd, std::vector<FrameBarrier>& barriers)
+		{
+			if (barriers.empty())
+			{
+				return;
+			}
+			bufferBarriers.clear();
+			imageBarriers.clear();
+			for (auto& barrier : barriers)
+			{
+				auto& resource = resources[barrier.resource];
+				if (resource.isImage)
+				{
+					imageBarriers.emplace_back(vk::ImageMemoryBarrier2(
+						barrier.srcStages, barrier.srcAccess,
+						barrier.dstStages, barrier.dstAccess,
+						barrier.oldLayout, barrier.newLayout,
+						VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+						resource.image.image, resource.subresourceRange));
+				}
+				else
+				{
+					//Sectors are resolved here since the buffer manager can move them between compiles
+					bufferBarriers.emplace_back(vk::BufferMemoryBarrier2(
+						barrier.srcStages, barrier.srcAccess,
+						barrier.dstStages, barrier.dstAccess,
+						VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+						resource.sector->bufferAllocation->bufferData.buffer,
+						resource.sector->allocationOffset,
+						resource.sector->allocatedSize));
+				}
+			}
+			cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, bufferBarriers.size(), bufferBarriers.data(), imageBarriers.size(), imageBarriers.data()));
+		};
+
+		for (auto manager : managerOrder)
+		{
+			manager->Reset();
+			//Uncached passes share a one time buffer until a cached pass splits them, barriers and timestamps still apply across buffers of one submission
+			vk::CommandBuffer cmd;
+			auto currentCmd = [&]()
+			{
+				if (cmd == VK_NULL_HANDLE)
+				{
+					cmd = manager->RecordNew();
+					cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+				}
+				return cmd;
+			};
+			for (auto passIndex : passOrder)
+			{
+				auto& pass = passes[passIndex];
+				if (pass.manager != manager)
+				{
+					continue;
+				}
+				auto recordPass = [&](vk::CommandBuffer passCmd)
+				{
+					recordBarriers(passCmd, pass.preBarriers);
+					if (pass.record)
+					{
+						pass.record(passCmd);
+					}
+					recordBarriers(passCmd, pass.postBarriers);
+				};
+				bool statistics = pass.collectStatistics && manager->PipelineStatisticsEnabled();
+				if (manager->ProfilingEnabled())
+				{
+					manager->BeginZone(currentCmd(), pass.name);
+				}
+				if (pass.cached && !statistics)
+				{
+					if (cmd != VK_NULL_HANDLE)
+					{
+						cmd.end();
+						cmd = VK_NULL_HANDLE;
+					}
+					manager->RecordCached(pass.cacheKey, pass.cacheVersion, recordPass);
+				}
+				else if (statistics)
+				{
+					manager->BeginStatistics(currentCmd(), pass.name, pass.statisticsObjectCount);
+					recordPass(cmd);
+					manager->EndStatistics(cmd);
+				}
+				else
+				{
+					recordPass(currentCmd());
+				}
+				if (manager->ProfilingEnabled())
+				{
+					manager->EndZone(currentCmd());
+				}
+			}
+			if (cmd != VK_NULL_HANDLE)
+			{
+				cmd.end();
+			}
+			bool useNormalSignal = std::find(normalSignalManagers.begin(), normalSignalManagers.end(), manager) != normalSignalManagers.end();
+			//The producers come earlier in the manager order, so their submit counts already are the values of this execution
+			SemaphoreWaits edgeWaits;
+			for (uint64_t i = 0; i < managerEdges.size(); i++)
+			{
+				auto& edge = managerEdges[i];
+				if (edge.second == manager)
+				{
+					MergeWait(edgeWaits, SemaphoreWait{ edge.first->GetMainTimelineSignal().semaphore, edge.first->GetSubmitCount(), managerEdgeStages[i] });
+				}
+			}
+			manager->DependsOnNext(edgeWaits);
+			manager->Execute(batcher, true, useNormalSignal, true);
+		}
+	}
+	void FrameGraph::Clear()
+	{
+		resources.clear();
+		passes.clear();
+		passOrder.clear();
+		managerOrder.clear();
+		normalSignalManagers.clear();
+		managerEdges.clear();
+		managerEdgeStages.clear();
+		compiled = false;
+	}
+	std::vector<uint32_t> FrameGraph::GetPassOrder()
+	{
+		return passOrder;
+	}
+	std::vector<CommandManager*> FrameGraph::GetManagerOrder()
+	{
+		return managerOrder;
+	}
+
+	void FrameGraph::CullPasses()
+	{
+		//Walk back from the outputs, a resource stays needed once a living pass uses it since writes may only cover part of it
+		std::vector<bool> needed(resources.size());
+		for (uint64_t i = 0; i < resources.size(); i++)
+		{
+			needed[i] = resources[i].output;
+		}
+		for (uint64_t i = passes.size(); i > 0; i--)
+		{
+			auto& pass = passes[i - 1];
+			pass.culled = !pass.sideEffects;
+			for (auto& usage : pass.usages)
+			{
+				if (usage.write && needed[usage.resource])
+				{
+					pass.culled = false;
+				}
+			}
+			if (!pass.culled)
+			{
+				for (auto& usage : pass.usages)
+				{
+					needed[usage.resource] = true;
+				}
+			}
+		}
+	}
+	void FrameGraph::SortPasses()
+	{
+		struct ResourceHistory
+		{
+			int64_t lastWriter = -1;
+			std::vector<uint32_t> readers;
+			vk::ImageLayout layout;
+		};
+		std::vector<ResourceHistory> histories(resources.size());
+		for (uint64_t i = 0; i < resources.size(); i++)
+		{
+			histories[i].layout = resources[i].initialLayout;
+		}
+
+		auto addDependency = [](FramePass& pass, uint32_t dependency, vk::PipelineStageFlags2 stages)
+		{
+			for (auto& existing : pass.dependencies)
+			{
+				if (existing.first == dependency)
+				{
+					existing.second |= stages;
+					return;
+				}
+			}
+			pass.dependencies.emplace_back(dependency, stages);
+		};
+
+		for (uint32_t i = 0; i < passes.size(); i++)
+		{
+			auto& pass = passes[i];
+			pass.dependencies.clear();
+			if (pass.culled)
+			{
+				continue;
+			}
+			for (auto& usage : pass.usages)
+			{
+				auto& history = histories[usage.resource];
+				bool transitions = resources[usage.resource].isImage && usage.layout != vk::ImageLayout::eUndefined && usage.layout != history.layout;
+				if (history.lastWriter >= 0)
+				{
+					addDependency(pass, history.lastWriter, usage.stages);
+				}
+				if (usage.write || transitions)
+				{
+					for (auto reader : history.readers)
+					{
+						if (reader != i)
+						{
+							addDependency(pass, reader, usage.stages);
+						}
+					}
+					history.readers.clear();
+					history.lastWriter = i;
+				}
+				else
+				{
+					history.readers.emplace_back(i);
+				}
+				if (transitions)
+				{
+					history.layout = usage.layout;
+				}
+			}
+		}
+
+		//Kahns algorithm, ready passes on the manager of the previous pass are preferred to keep each managers passes together
+		std::vector<uint64_t> remainingDependencies(passes.size());
+		std::vector<std::vector<uint32_t>> dependents(passes.size());
+		std::vector<uint32_t> ready;
+		for (uint32_t i = 0; i < passes.size(); i++)
+		{
+			remainingDependencies[i] = passes[i].dependencies.size();
+			for (auto& dependency : passes[i].dependencies)
+			{
+				dependents[dependency.first].emplace_back(i);
+			}
+			if (!passes[i].culled && remainingDependencies[i] == 0)
+			{
+				ready.emplace_back(i);
+			}
+		}
+		passOrder.clear();
+		CommandManager* previousManager = nullptr;
+		while (!ready.empty())
+		{
+			uint64_t pick = 0;
+			for (uint64_t i = 0; i < ready.size(); i++)
+			{
+				bool sameManager = passes[ready[i]].manager == previousManager;
+				bool pickSameManager = passes[ready[pick]].manager == previousManager;
+				if ((sameManager && !pickSameManager) || (sameManager == pickSameManager && ready[i] < ready[pick]))
+				{
+					pick = i;
+				}
+			}
+			uint32_t passIndex = ready[pick];
+			ready.erase(ready.begin() + pick);
+			passOrder.emplace_back(passIndex);
+			previousManager = passes[passIndex].manager;
+			for (auto dependent : dependents[passIndex])
+			{
+				remainingDependencies[dependent]--;
+				if (remainingDependencies[dependent] == 0)
+				{
+					ready.emplace_back(dependent);
+				}
+			}
+		}
+	}
+	bool FrameGraph::SortManagers()
+	{
+		std::vector<CommandManager*> managers;
+		for (auto passIndex : passOrder)
+		{
+			if (std::find(managers.begin(), managers.end(), passes[passIndex].manager) == managers.end())
+			{
+				managers.emplace_back(passes[passIndex].manager);
+			}
+		}
+
+		managerEdges.clear();
+		managerEdgeStages.clear();
+		for (auto passIndex : passOrder)
+		{
+			auto& pass = passes[passIndex];
+			for (auto& dependency : pass.dependencies)
+			{
+				auto producer = passes[dependency.first].manager;
+				if (producer == pass.manager)
+				{
+					continue;
+				}
+				auto edge = std::make_pair(producer, pass.manager);
+				auto found = std::find(managerEdges.begin(), managerEdges.end(), edge);
+				if (found == managerEdges.end())
+				{
+					managerEdges.emplace_back(edge);
+					managerEdgeStages.emplace_back(dependency.second);
+				}
+				else
+				{
+					managerEdgeStages[found - managerEdges.begin()] |= dependency.second;
+				}
+			}
+		}
+
+		//Every manager is submitted once, so the managers themselves must form an acyclic graph
+		managerOrder.clear();
+		std::vector<bool> emitted(managers.size(), false);
+		while (managerOrder.size() < managers.size())
+		{
+			bool progressed = false;
+			for (uint64_t i = 0; i < managers.size(); i++)
+			{
+				if (emitted[i])
+				{
+					continue;
+				}
+				bool isReady = true;
+				for (auto& edge : managerEdges)
+				{
+					if (edge.second == managers[i] && std::find(managerOrder.begin(), managerOrder.end(), edge.first) == managerOrder.end())
+					{
+						isReady = false;
+					}
+				}
+				if (isReady)
+				{
+					emitted[i] = true;
+					managerOrder.emplace_back(managers[i]);
+					progressed = true;
+				}
+			}
+			if (!progressed)
+			{
+				//A cycle between managers, the managers that are left can not be ordered
+				managerOrder.clear();
+				return false;
+			}
+		}
+		return true;
+	}
+	void FrameGraph::ComputeBarriers()
+	{
+		//A null manager marks the state the resource was imported with, it applies to every manager
+		struct ResourceState
+		{
+			CommandManager* writeManager = nullptr;
+			vk::PipelineStageFlags2 writeStages;
+			vk::AccessFlags2 writeAccess;
+			std::vector<std::pair<CommandManager*, vk::PipelineStageFlags2>> readStages;
+			vk::PipelineStageFlags2 visibleStages;
+			vk::AccessFlags2 visibleAccess;
+			vk::ImageLayout layout;
+			int64_t lastPass = -1;
+		};
+		std::vector<ResourceState> states(resources.size());
+		for (uint64_t i = 0; i < resources.size(); i++)
+		{
+			states[i].writeStages = resources[i].initialStages;
+			states[i].writeAccess = resources[i].initialAccess;
+			states[i].layout = resources[i].initialLayout;
+		}
+
+		for (auto passIndex : passOrder)
+		{
+			auto& pass = passes[passIndex];
+			pass.preBarriers.clear();
+			pass.postBarriers.clear();
+			for (auto& usage : pass.usages)
+			{
+				auto& state = states[usage.resource];
+				bool transitions = resources[usage.resource].isImage && usage.layout != vk::ImageLayout::eUndefined && usage.layout != state.layout;
+				bool sameWriteManager = state.writeManager == pass.manager || state.writeManager == nullptr;
+				FrameBarrier barrier{ usage.resource, vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone, usage.stages, usage.access, state.layout, transitions ? usage.layout : state.layout };
+
+				if (usage.write || transitions)
+				{
+					if (sameWriteManager)
+					{
+						barrier.srcStages |= state.writeStages;
+						barrier.srcAccess |= state.writeAccess;
+					}
+					for (auto& read : state.readStages)
+					{
+						if (read.first == pass.manager)
+						{
+							barrier.srcStages |= read.second;
+						}
+					}
+				}
+				else if (sameWriteManager && (usage.stages & ~state.visibleStages || usage.access & ~state.visibleAccess))
+				{
+					barrier.srcStages = state.writeStages;
+					barrier.srcAccess = state.writeAccess;
+				}
+
+				//Accesses on other managers are covered by the timeline wait on the dst stages, transitions chain with that wait
+				if (transitions && barrier.srcStages == vk::PipelineStageFlagBits2::eNone && !sameWriteManager)
+				{
+					barrier.srcStages = usage.stages;
+				}
+				if (transitions || barrier.srcStages != vk::PipelineStageFlagBits2::eNone)
+				{
+					pass.preBarriers.emplace_back(barrier);
+				}
+
+				if (usage.write || transitions)
+				{
+					state.writeManager = pass.manager;
+					state.writeStages = usage.stages;
+					state.writeAccess = usage.write ? usage.access : vk::AccessFlagBits2::eNone;
+					state.readStages.clear();
+					//A write is not visible to anything yet, even to the stages that made it, a transition makes memory visible to its own dst scope
+					state.visibleStages = usage.write ? vk::PipelineStageFlagBits2::eNone : usage.stages;
+					state.visibleAccess = usage.write ? vk::AccessFlagBits2::eNone : usage.access;
+				}
+				if (!usage.write)
+				{
+					auto read = std::find_if(state.readStages.begin(), state.readStages.end(), [&](auto& entry) { return entry.first == pass.manager; });
+					if (read == state.readStages.end())
+					{
+						state.readStages.emplace_back(pass.manager, usage.stages);
+					}
+					else
+					{
+						read->second |= usage.stages;
+					}
+					if (sameWriteManager)
+					{
+						state.visibleStages |= usage.stages;
+						state.visibleAccess |= usage.access;
+					}
+				}
+				state.layout = barrier.newLayout;
+				state.lastPass = passIndex;
+			}
+		}
+
+		for (uint32_t i = 0; i < resources.size(); i++)
+		{
+			auto& resource = resources[i];
+			auto& state = states[i];
+			if (state.lastPass < 0)
+			{
+				continue;
+			}
+			bool transitions = resource.isImage && resource.finalLayout != vk::ImageLayout::eUndefined && resource.finalLayout != state.layout;
+			if (!transitions && resource.finalStages == vk::PipelineStageFlagBits2::eNone)
+			{
+				continue;
+			}
+			auto& pass = passes[state.lastPass];
+			FrameBarrier barrier{ i, vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone, resource.finalStages, resource.finalAccess, state.layout, transitions ? resource.finalLayout : state.layout };
+			if (state.writeManager == pass.manager)
+			{
+				barrier.srcStages |= state.writeStages;
+				barrier.srcAccess |= state.writeAccess;
+			}
+			for (auto& read : state.readStages)
+			{
+				if (read.first == pass.manager)
+				{
+					barrier.srcStages |= read.second;
+				}
+			}
+			pass.postBarriers.emplace_back(barrier);
+		}
+	}
+}
@@ -0,0 +1,157 @@
+#include "../Headers/VulkanToolbox.hpp"
+#include <VkBootstrap.h>
+
+namespace vkt
+{
+	bool BootstrapHeadless(ObjectManager& vom, HeadlessOptions options)
+	{
+		vkb::InstanceBuilder instanceBuilder;
+		instanceBuilder.set_app_name(options.appName)
+			.set_engine_name("VulkanToolbox")
+			.require_api_version(options.apiMajor, options.apiMinor)
+			.set_headless(true);
+		if (options.validation)
+		{
+			instanceBuilder.enable_validation_layers();
+		}
+		auto instanceRet = instanceBuilder.build();
+		if (!instanceRet)
+		{
+			return false;
+		}
+		vkb::Instance bootInstance = instanceRet.value();
+
+		//Only what the toolbox itself relies on is required, so software implementations qualify
+		VkPhysicalDeviceFeatures features{}; features.pipelineStatisticsQuery = options.pipelineStatistics;
+		VkPhysicalDeviceVulkan12Features features12{}; features12.timelineSemaphore = VK_TRUE;
+		if (options.bindless)
+		{
+			BindlessTable::RequireFeatures(features12);
+		}
+		VkPhysicalDeviceVulkan13Features features13{}; features13.dynamicRendering = VK_TRUE; features13.synchronization2 = VK_TRUE;
+
+		vkb::PhysicalDeviceSelector physicalDeviceSelector(bootInstance);
+		physicalDeviceSelector
+			.set_minimum_version(options.apiMajor, options.apiMinor)
+			.prefer_gpu_device_type(vkb::PreferredDeviceType::discrete)
+			.allow_any_gpu_device_type(options.allowSoftware)
+			.add_desired_extension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+		if (options.descriptorBuffer)
+		{
+			features12.bufferDeviceAddress = VK_TRUE;
+			VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures{};
+			descriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+			descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
+			physicalDeviceSelector
+				.add_required_extension(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)
+				.add_required_extension_features(descriptorBufferFeatures);
+		}
+		auto physicalDeviceRet = physicalDeviceSelector
+			.set_required_features(features)
+			.set_required_features_12(features12)
+			.set_required_features_13(features13)
+			.select();
+		if (!physicalDeviceRet)
+		{
+			vkb::destroy_instance(bootInstance);
+			return false;
+		}
+
+		vkb::DeviceBuilder deviceBuilder{ physicalDeviceRet.value() };
+		auto deviceRet = deviceBuilder.build();
+		if (!deviceRet)
+		{
+			vkb::destroy_instance(bootInstance);
+			return false;
+		}
+		vkb::Device bootDevice = deviceRet.value();
+
+		vom.SetDevice(bootDevice.device);
+		vom.Manage(vom.GetDevice());
+		vom.SetInstance(bootInstance.instance);
+		vom.Manage(vom.GetInstance());
+		vom.SetPhysicalDevice(bootDevice.physical_device.physical_device);
+		vom.SetEnabledFeatures(EnabledFeatures{ options.descriptorBuffer, options.descriptorBuffer });
+		vom.MakeAllocator(VK_MAKE_API_VERSION(0, options.apiMajor, options.apiMinor, 0), true, true, options.descriptorBuffer ? VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT : 0);
+
+		QueueData graphicsQueue{ bootDevice.get_queue_index(vkb::QueueType::graphics).value(), bootDevice.get_queue(vkb::QueueType::graphics).value() };
+		//Dedicated transfer and compute families are used when they exist, otherwise everything shares the graphics queue
+		auto queueOrGraphics = [&bootDevice, &graphicsQueue](vkb::QueueType type)
+		{
+			auto index = bootDevice.get_queue_index(type);
+			auto queue = bootDevice.get_queue(type);
+			if (!index || !queue)
+			{
+				return graphicsQueue;
+			}
+			return QueueData{ index.value(), queue.value() };
+		};
+		vom.SetQueues(graphicsQueue, queueOrGraphics(vkb::QueueType::transfer), queueOrGraphics(vkb::QueueType::compute));
+		vom.SetGeneralQueue(graphicsQueue);
+		return true;
+	}
+
+
+
+	OffscreenTarget::OffscreenTarget(ObjectManager& _vom, vk::Extent2D _extent, vk::Format _format, uint32_t imageCount)
+		: vom(_vom), extent(_extent), format(_format)
+	{
+		vom.SetAllocator(_vom.GetAllocator());
+		auto queue = _vom.GetGraphicsQueue();
+		//All images are transitioned with one submission, the context waits for it when it goes out of scope
+		ImmediateSubmitContext setup(_vom, queue);
+		for (uint32_t i = 0; i < imageCount; i++)
+		{
+			images.emplace_back(vom.VmaMakeImage(
+				setup,
+				vk::ImageCreateInfo(
+					{},
+					vk::ImageType::e2D,
+					format,
+					vk::Extent3D(extent.width, extent.height, 1),
+					1,
+					1,
+					vk::SampleCountFlagBits::e1,
+					vk::ImageTiling::eOptimal,
+					vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled,
+					vk::SharingMode::eExclusive,
+					1,
+					&queue.index,
+					vk::ImageLayout::eColorAttachmentOptimal),
+				vk::ImageViewCreateInfo(
+					{},
+					{},
+					vk::ImageViewType::e2D,
+					format,
+					vk::ComponentMapping(),
+					vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)),
+				VmaAllocationCreateInfo{
+					{},
+					VMA_MEMORY_USAGE_GPU_ONLY }));
+		}
+		setup.Flush();
+	}
+
+	uint32_t OffscreenTarget::Acquire()
+	{
+		uint32_t index = nextImage;
+		nextImage = (nextImage + 1) % images.size();
+		return index;
+	}
+	VmaImage OffscreenTarget::GetImage(uint64_t index)
+	{
+		return images[index];
+	}
+	std::vector<VmaImage>& OffscreenTarget::GetImages()
+	{
+		return images;
+	}
+	vk::Format OffscreenTarget::GetFormat()
+	{
+		return format;
+	}
+	vk::Extent2D OffscreenTarget::GetExtent()
+	{
+		return extent;
+	}
+}
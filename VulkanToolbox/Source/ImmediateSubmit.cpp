@@ -0,0 +1,94 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	ImmediateSubmitContext::ImmediateSubmitContext(ObjectManager& _vom, QueueData _queue)
+		: vom(_vom), queue(_queue)
+	{
+		assert(queue.queue != NULL);
+		//The pool and timeline belong to the context, a DestroyAll or RetireAll on the vom must not take them away while it is alive
+		commandPool = vom.MakeCommandPool(vk::CommandPoolCreateInfo(vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient, queue.index), false);
+		timeline = vom.MakeTimelineSemaphore(0, false);
+	}
+	ImmediateSubmitContext::ImmediateSubmitContext(ObjectManager& _vom)
+		: ImmediateSubmitContext(_vom, _vom.GetGraphicsQueue())
+	{
+	}
+	ImmediateSubmitContext::~ImmediateSubmitContext()
+	{
+		Flush();
+		Wait();
+		vom.GetDevice().destroyCommandPool(commandPool);
+		vom.GetDevice().destroySemaphore(timeline);
+	}
+
+	void ImmediateSubmitContext::Transition(const std::vector<vk::ImageMemoryBarrier2>& transitions)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		barriers.insert(barriers.end(), transitions.begin(), transitions.end());
+	}
+	uint64_t ImmediateSubmitContext::Flush()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (barriers.empty())
+		{
+			return submitted;
+		}
+		auto cmd = NextCommandBuffer();
+		cmd.begin(vk::CommandBufferBeginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit));
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, barriers.size(), barriers.data()));
+		cmd.end();
+		barriers.clear();
+
+		submitted++;
+		vk::CommandBufferSubmitInfo cmdInfo(cmd);
+		vk::SemaphoreSubmitInfo signalInfo(timeline, submitted, vk::PipelineStageFlagBits2::eAllCommands);
+		vk::SubmitInfo2 submit({}, 0, nullptr, 1, &cmdInfo, 1, &signalInfo);
+		{
+			std::lock_guard<std::mutex> queueLock(QueueMutex(queue.queue));
+			auto res = queue.queue.submit2(1, &submit, VK_NULL_HANDLE);
+		}
+		inFlight.emplace_back(InFlightCommandBuffer{ cmd, submitted });
+		return submitted;
+	}
+	void ImmediateSubmitContext::Wait()
+	{
+		uint64_t value = GetLastValue();
+		vk::SemaphoreWaitInfo waitInfo({}, 1, &timeline, &value);
+		auto res = vom.GetDevice().waitSemaphores(waitInfo, UINT64_MAX);
+	}
+	bool ImmediateSubmitContext::Finished()
+	{
+		return vom.GetDevice().getSemaphoreCounterValue(timeline) >= GetLastValue();
+	}
+	SemaphoreWait ImmediateSubmitContext::GetWait(vk::PipelineStageFlags2 stage)
+	{
+		return SemaphoreWait{ timeline, GetLastValue(), stage };
+	}
+	vk::Semaphore ImmediateSubmitContext::GetTimeline()
+	{
+		return timeline;
+	}
+	uint64_t ImmediateSubmitContext::GetLastValue()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return submitted;
+	}
+
+	vk::CommandBuffer ImmediateSubmitContext::NextCommandBuffer()
+	{
+		uint64_t reached = vom.GetDevice().getSemaphoreCounterValue(timeline);
+		for (size_t i = 0; i < inFlight.size(); i++)
+		{
+			if (inFlight[i].value <= reached)
+			{
+				//The pool resets the buffer implicitly when it is begun again
+				auto cmd = inFlight[i].cmd;
+				inFlight[i] = inFlight.back();
+				inFlight.pop_back();
+				return cmd;
+			}
+		}
+		return vom.MakeCommandBuffers(vk::CommandBufferAllocateInfo(commandPool, vk::CommandBufferLevel::ePrimary, 1))[0];
+	}
+}
@@ -0,0 +1,56 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	//Indirect commands read their arguments at offsets that must be a multiple of 4 from buffers created with the indirect usage
+	static void AssertIndirectSector(std::shared_ptr<SectorData>& sector, uint64_t offset, uint64_t size)
+	{
+		assert(sector != nullptr && sector->bufferAllocation != nullptr);
+		assert(sector->bufferAllocation->bufferCreateInfo.usage & vk::BufferUsageFlagBits::eIndirectBuffer);
+		assert((sector->allocationOffset + offset) % 4 == 0);
+		assert(offset + size <= sector->neededSize);
+	}
+
+	void DispatchIndirect(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, uint64_t offset)
+	{
+		AssertIndirectSector(arguments, offset, sizeof(vk::DispatchIndirectCommand));
+		cmd.dispatchIndirect(arguments->bufferAllocation->bufferData.buffer, arguments->allocationOffset + offset);
+	}
+	void DrawIndirect(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, uint32_t drawCount, uint64_t offset, uint32_t stride)
+	{
+		AssertIndirectSector(arguments, offset, (drawCount == 0) ? 0 : uint64_t(stride) * (drawCount - 1) + sizeof(vk::DrawIndirectCommand));
+		cmd.drawIndirect(arguments->bufferAllocation->bufferData.buffer, arguments->allocationOffset + offset, drawCount, stride);
+	}
+	void DrawIndexedIndirect(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, uint32_t drawCount, uint64_t offset, uint32_t stride)
+	{
+		AssertIndirectSector(arguments, offset, (drawCount == 0) ? 0 : uint64_t(stride) * (drawCount - 1) + sizeof(vk::DrawIndexedIndirectCommand));
+		cmd.drawIndexedIndirect(arguments->bufferAllocation->bufferData.buffer, arguments->allocationOffset + offset, drawCount, stride);
+	}
+	void DrawIndirectCount(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, std::shared_ptr<SectorData> count, uint32_t maxDrawCount, uint64_t offset, uint64_t countOffset, uint32_t stride)
+	{
+		AssertIndirectSector(arguments, offset, (maxDrawCount == 0) ? 0 : uint64_t(stride) * (maxDrawCount - 1) + sizeof(vk::DrawIndirectCommand));
+		AssertIndirectSector(count, countOffset, sizeof(uint32_t));
+		cmd.drawIndirectCount(
+			arguments->bufferAllocation->bufferData.buffer, arguments->allocationOffset + offset,
+			count->bufferAllocation->bufferData.buffer, count->allocationOffset + countOffset,
+			maxDrawCount, stride);
+	}
+	void DrawIndexedIndirectCount(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, std::shared_ptr<SectorData> count, uint32_t maxDrawCount, uint64_t offset, uint64_t countOffset, uint32_t stride)
+	{
+		AssertIndirectSector(arguments, offset, (maxDrawCount == 0) ? 0 : uint64_t(stride) * (maxDrawCount - 1) + sizeof(vk::DrawIndexedIndirectCommand));
+		AssertIndirectSector(count, countOffset, sizeof(uint32_t));
+		cmd.drawIndexedIndirectCount(
+			arguments->bufferAllocation->bufferData.buffer, arguments->allocationOffset + offset,
+			count->bufferAllocation->bufferData.buffer, count->allocationOffset + countOffset,
+			maxDrawCount, stride);
+	}
+	void IndirectArgumentBarrier(vk::CommandBuffer cmd, std::shared_ptr<SectorData> arguments, vk::PipelineStageFlags2 srcStages, vk::AccessFlags2 srcAccess)
+	{
+		vk::BufferMemoryBarrier2 barrier(
+			srcStages, srcAccess,
+			vk::PipelineStageFlagBits2::eDrawIndirect, vk::AccessFlagBits2::eIndirectCommandRead,
+			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+			arguments->bufferAllocation->bufferData.buffer, arguments->allocationOffset, arguments->allocatedSize);
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 1, &barrier, 0, {}));
+	}
+}
@@ -0,0 +1,274 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	JobSystem::JobSystem(ObjectManager& _vom, uint32_t workerCount)
+		: vom(_vom), completion(vom)
+	{
+		Start(workerCount);
+	}
+	JobSystem::JobSystem(vk::Device deviceHandle, uint32_t workerCount)
+		: vom(deviceHandle), completion(vom)
+	{
+		Start(workerCount);
+	}
+	JobSystem::~JobSystem()
+	{
+		Stop();
+	}
+
+	JobHandle JobSystem::Schedule(std::function<void()> work, std::vector<JobHandle> dependencies, std::vector<TimelinePoint> gpuWaits, std::vector<TimelinePoint> signals)
+	{
+		assert(running);
+		auto job = std::make_shared<Job>();
+		job->work = std::move(work);
+		job->signals = std::move(signals);
+		unfinished.fetch_add(1, std::memory_order_relaxed);
+
+		for (auto& dependency : dependencies)
+		{
+			assert(dependency != nullptr);
+			std::lock_guard<std::mutex> lock(dependency->continuationMutex);
+			if (!dependency->finished.load(std::memory_order_acquire))
+			{
+				job->pendingCount.fetch_add(1, std::memory_order_relaxed);
+				dependency->continuations.emplace_back(job);
+			}
+		}
+		for (auto& wait : gpuWaits)
+		{
+			if (vom.GetDevice().getSemaphoreCounterValue(wait.semaphore) >= wait.value)
+			{
+				continue;
+			}
+			job->pendingCount.fetch_add(1, std::memory_order_relaxed);
+			completion.OnComplete(wait.semaphore, wait.value, [this, job]()
+				{
+					Release(job, ExternalQueue);
+				});
+		}
+		if (job->pendingCount.load(std::memory_order_relaxed) > 1)
+		{
+			TrackWaiting(job);
+		}
+		Release(job, ExternalQueue);
+		return job;
+	}
+	JobHandle JobSystem::SignalAfter(std::vector<JobHandle> dependencies, std::vector<TimelinePoint> signals)
+	{
+		return Schedule({}, std::move(dependencies), {}, std::move(signals));
+	}
+	bool JobSystem::IsFinished(JobHandle job)
+	{
+		return job->finished.load(std::memory_order_acquire);
+	}
+	void JobSystem::Wait(JobHandle job)
+	{
+		JobHandle other;
+		while (!job->finished.load(std::memory_order_acquire))
+		{
+			if (TryPop(other, ExternalQueue))
+			{
+				RunJob(other, ExternalQueue);
+				other = nullptr;
+				continue;
+			}
+			job->finished.wait(false, std::memory_order_acquire);
+		}
+	}
+	void JobSystem::WaitAll()
+	{
+		JobHandle other;
+		uint64_t current = unfinished.load(std::memory_order_acquire);
+		while (current > 0)
+		{
+			if (TryPop(other, ExternalQueue))
+			{
+				RunJob(other, ExternalQueue);
+				other = nullptr;
+			}
+			else
+			{
+				unfinished.wait(current, std::memory_order_acquire);
+			}
+			current = unfinished.load(std::memory_order_acquire);
+		}
+	}
+	void JobSystem::Stop()
+	{
+		if (!running.exchange(false))
+		{
+			return;
+		}
+		//Callbacks of the completion service release jobs, so it has to stop before the queues go away
+		completion.Stop();
+		wakeCount.fetch_add(1, std::memory_order_release);
+		wakeCount.notify_all();
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+		workers.clear();
+		//Nothing can make the remaining jobs ready anymore, their dependencies were cancelled as well or their gpu callbacks were dropped
+		std::vector<JobHandle> waiting;
+		{
+			std::lock_guard<std::mutex> lock(waitingMutex);
+			waiting.swap(waitingJobs);
+		}
+		for (auto& job : waiting)
+		{
+			if (!job->finished.load(std::memory_order_acquire))
+			{
+				Cancel(job);
+			}
+		}
+	}
+	uint32_t JobSystem::WorkerCount()
+	{
+		return static_cast<uint32_t>(workers.size());
+	}
+	TimelinePoint JobSystem::LatestSubmission(CommandManager& manager)
+	{
+		return TimelinePoint{ manager.GetMainTimelineSignal().semaphore, manager.GetSubmitCount() };
+	}
+
+	void JobSystem::Start(uint32_t workerCount)
+	{
+		if (workerCount == 0)
+		{
+			workerCount = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+		running = true;
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			queues.emplace_back(std::make_unique<WorkerQueue>());
+		}
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+	}
+	void JobSystem::Notify()
+	{
+		wakeCount.fetch_add(1, std::memory_order_release);
+		wakeCount.notify_one();
+	}
+	void JobSystem::Release(const JobHandle& job, uint64_t queueIndex)
+	{
+		if (job->pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Push(job, queueIndex);
+		}
+	}
+	void JobSystem::Push(const JobHandle& job, uint64_t queueIndex)
+	{
+		//Jobs that became ready outside of a worker are spread over the queues
+		if (queueIndex >= queues.size())
+		{
+			queueIndex = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+		}
+		{
+			std::lock_guard<std::mutex> lock(queues[queueIndex]->mutex);
+			queues[queueIndex]->jobs.emplace_back(job);
+		}
+		Notify();
+	}
+	bool JobSystem::TryPop(JobHandle& job, uint64_t queueIndex)
+	{
+		if (queueIndex < queues.size())
+		{
+			auto& own = *queues[queueIndex];
+			std::lock_guard<std::mutex> lock(own.mutex);
+			if (!own.jobs.empty())
+			{
+				job = std::move(own.jobs.back());
+				own.jobs.pop_back();
+				return true;
+			}
+		}
+		uint64_t start = (queueIndex < queues.size()) ? queueIndex + 1 : nextQueue.load(std::memory_order_relaxed);
+		for (uint64_t i = 0; i < queues.size(); i++)
+		{
+			auto& victim = *queues[(start + i) % queues.size()];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.jobs.empty())
+			{
+				job = std::move(victim.jobs.front());
+				victim.jobs.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+	void JobSystem::RunJob(const JobHandle& job, uint64_t queueIndex)
+	{
+		if (job->work)
+		{
+			job->work();
+			job->work = nullptr;
+		}
+		for (auto& signal : job->signals)
+		{
+			vk::SemaphoreSignalInfo signalInfo(signal.semaphore, signal.value);
+			auto res = vom.GetDevice().signalSemaphore(signalInfo);
+		}
+
+		std::vector<JobHandle> ready;
+		{
+			std::lock_guard<std::mutex> lock(job->continuationMutex);
+			job->finished.store(true, std::memory_order_release);
+			ready.swap(job->continuations);
+		}
+		job->finished.notify_all();
+		for (auto& continuation : ready)
+		{
+			Release(continuation, queueIndex);
+		}
+		unfinished.fetch_sub(1, std::memory_order_acq_rel);
+		unfinished.notify_all();
+	}
+	void JobSystem::TrackWaiting(const JobHandle& job)
+	{
+		std::lock_guard<std::mutex> lock(waitingMutex);
+		//Finished jobs are only pruned once the list doubled, so tracking stays amortized constant
+		if (waitingJobs.size() >= waitingPruneSize)
+		{
+			std::erase_if(waitingJobs, [](const JobHandle& waiting) { return waiting->finished.load(std::memory_order_acquire); });
+			waitingPruneSize = (std::max)(size_t(64), waitingJobs.size() * 2);
+		}
+		waitingJobs.emplace_back(job);
+	}
+	void JobSystem::Cancel(const JobHandle& job)
+	{
+		job->cancelled.store(true, std::memory_order_relaxed);
+		job->work = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(job->continuationMutex);
+			job->finished.store(true, std::memory_order_release);
+			job->continuations.clear();
+		}
+		job->finished.notify_all();
+		unfinished.fetch_sub(1, std::memory_order_acq_rel);
+		unfinished.notify_all();
+	}
+	void JobSystem::WorkerLoop(uint64_t queueIndex)
+	{
+		JobHandle job;
+		while (true)
+		{
+			//Same pattern as the submission thread, a push after the search changes the wake count so the wait returns
+			uint64_t observedWake = wakeCount.load(std::memory_order_acquire);
+			if (TryPop(job, queueIndex))
+			{
+				RunJob(job, queueIndex);
+				job = nullptr;
+				continue;
+			}
+			if (!running.load(std::memory_order_acquire))
+			{
+				return;
+			}
+			wakeCount.wait(observedWake, std::memory_order_acquire);
+		}
+	}
+}
@@ -14,7 +14,7 @@ namespace vkt
 	}
 
 	BufferManager::BufferManager(vk::Device deviceHandle, VmaAllocator allocator, QueueData _transferQueue, vk::BufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsageFlags)
-		: cmdManager(deviceHandle, _transferQueue, true, vk::PipelineStageFlagBits::eTransfer), vom(deviceHandle)
+		: cmdManager(deviceHandle, _transferQueue, true, vk::PipelineStageFlagBits2::eTransfer), vom(deviceHandle)
 	{
 		vom.SetAllocator(allocator);
 		vom.SetTransferQueue(_transferQueue);
@@ -43,7 +43,7 @@ namespace vkt
 
 	}
 	BufferManager::BufferManager(ObjectManager& _vom, vk::BufferUsageFlags bufferUsageFlags, VmaMemoryUsage memoryUsageFlags)
-		: cmdManager(_vom, _vom.GetTransferQueue(), true, vk::PipelineStageFlagBits::eTransfer), vom(_vom)
+		: cmdManager(_vom, _vom.GetTransferQueue(), true, vk::PipelineStageFlagBits2::eTransfer), vom(_vom)
 	{
 		vom.SetDevice(_vom.GetDevice());
 		vom.SetAllocator(_vom.GetAllocator());
@@ -83,6 +83,7 @@ namespace vkt
 
 	void BufferManager::Update(bool wait)
 	{
+		vom.CollectRetired();
 		if (bufferCreateInfo.size == 0)
 		{
 			uint64_t currentOffset = 0;
@@ -96,6 +97,7 @@ namespace vkt
 			}
 			bufferCreateInfo.size = currentOffset;
 			bufferData = vom.VmaMakeBuffer(bufferCreateInfo, allocationCreateInfo, false);
+			relocationCount++;
 
 			return;
 		}
@@ -138,21 +140,34 @@ namespace vkt
 
 			auto newBufferAllocation = vom.VmaMakeBuffer(bufferCreateInfo, allocationCreateInfo, false);
 
-			if (copyOps.size() > 0)
+			//With registered users the submission is made even without a copy, its waits on their timelines are what the retire point relies on
+			if (copyOps.size() > 0 || hasUsers)
 			{
 				cmdManager.Reset();
-				auto transferBuffer = cmdManager.RecordNew();
-				transferBuffer.begin(vk::CommandBufferBeginInfo({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit }));
-				transferBuffer.copyBuffer(bufferData.buffer, newBufferAllocation.buffer, copyOps.size(), copyOps.data());
-				transferBuffer.end();
+				if (copyOps.size() > 0)
+				{
+					auto transferBuffer = cmdManager.RecordNew();
+					transferBuffer.begin(vk::CommandBufferBeginInfo({ vk::CommandBufferUsageFlagBits::eOneTimeSubmit }));
+					transferBuffer.copyBuffer(bufferData.buffer, newBufferAllocation.buffer, copyOps.size(), copyOps.data());
+					transferBuffer.end();
+				}
 				cmdManager.Execute(true, wait, false, false);
 			}
 
-			vom.Manage(bufferData);
+			//The old buffer lives until the copy out of it finished, the copy itself waited on the latest use of every timeline registered with UsedOn
+			vom.Retire(bufferData, cmdManager.GetMainTimelineSignal().semaphore, cmdManager.GetSubmitCount());
 			bufferData = newBufferAllocation;
+			relocationCount++;
 		}
 	}
 
+	void BufferManager::UsedOn(vk::Semaphore semaphore, std::shared_ptr<uint64_t> valuePtr)
+	{
+		assert(semaphore != NULL && valuePtr != nullptr);
+		cmdManager.DependsOn(std::vector<WaitData>{ WaitData(valuePtr, semaphore, vk::PipelineStageFlagBits2::eTransfer) });
+		hasUsers = true;
+	}
+
 	void BufferManager::RemoveSector(std::shared_ptr<SectorData> sector)
 	{
 		auto iter = sectors.begin();
@@ -178,11 +193,15 @@ namespace vkt
 			vom.Manage(bufferData);
 		}
 		vom.DestroyAll();
+		bufferData = VmaBuffer();
 	}
 
 	BufferManager::~BufferManager()
 	{
-		vom.Manage(bufferData);
+		if (bufferData.buffer != NULL)
+		{
+			vom.Manage(bufferData);
+		}
 	}
 
 	SectorToSectorEntity::SectorToSectorEntity(
@@ -196,7 +215,7 @@ namespace vkt
 	{
 	}
 
-	std::vector<WaitData> SectorToSectorEntity::Record(vk::CommandBuffer cmd)
+	void SectorToSectorEntity::Record(vk::CommandBuffer cmd, SemaphoreWaits& waits)
 	{
 		srcVersion = srcSector->bufferAllocation->cmdManager.GetSubmitCount();
 		dstVersion = dstSector->bufferAllocation->cmdManager.GetSubmitCount();
@@ -204,8 +223,8 @@ namespace vkt
 		vk::BufferCopy copy(srcSector->allocationOffset, dstSector->allocationOffset, size);
 		cmd.copyBuffer(srcSector->bufferAllocation->bufferData.buffer, dstSector->bufferAllocation->bufferData.buffer, 1, &copy);
 
-		return { WaitData(srcSector->bufferAllocation->cmdManager.GetSubmitCountPtr(), srcSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer),
-		WaitData(dstSector->bufferAllocation->cmdManager.GetSubmitCountPtr(), dstSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer) };
+		MergeWait(waits, { srcSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, srcVersion, vk::PipelineStageFlagBits2::eCopy });
+		MergeWait(waits, { dstSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, dstVersion, vk::PipelineStageFlagBits2::eCopy });
 	}
 	bool SectorToSectorEntity::NeedsRecording()
 	{
@@ -224,33 +243,27 @@ namespace vkt
 	{
 	}
 
-	std::vector<WaitData> ImageToSectorEntity::Record(vk::CommandBuffer cmd)
+	void ImageToSectorEntity::Record(vk::CommandBuffer cmd, SemaphoreWaits& waits)
 	{
 		dstVersion = dstSector->bufferAllocation->cmdManager.GetSubmitCount();
 
 		bufferImageCopy.bufferOffset = dstSector->allocationOffset;
-		vk::ImageMemoryBarrier imageMemoryBarrier(vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite, srcImageFormat,
-			vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage,
+		//The copy only reads the image, the transition chains with the copy stage waits of the submission
+		vk::ImageMemoryBarrier2 imageMemoryBarrier(
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eNone,
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead,
+			srcImageFormat, vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage,
 			subresourceRange);
-		cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer,
-			vk::PipelineStageFlagBits::eTransfer,
-			{},
-			0, {},
-			0, {},
-			1, &imageMemoryBarrier);
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, 1, &imageMemoryBarrier));
 		cmd.copyImageToBuffer(srcImage, vk::ImageLayout::eTransferSrcOptimal, dstSector->bufferAllocation->bufferData.buffer, 1, &bufferImageCopy);
-		imageMemoryBarrier = vk::ImageMemoryBarrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eNoneKHR, vk::ImageLayout::eTransferSrcOptimal,
-			srcImageFormat, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage,
+		imageMemoryBarrier = vk::ImageMemoryBarrier2(
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eNone,
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite,
+			vk::ImageLayout::eTransferSrcOptimal, srcImageFormat, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage,
 			subresourceRange);
-		cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-			{},
-			0, {},
-			0, {},
-			1, &imageMemoryBarrier);
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, 1, &imageMemoryBarrier));
 
-		return { WaitData(dstSector->bufferAllocation->cmdManager.GetSubmitCountPtr(), dstSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer) };
+		MergeWait(waits, { dstSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, dstVersion, vk::PipelineStageFlagBits2::eCopy });
 	}
 
 	bool ImageToSectorEntity::NeedsRecording()
@@ -271,36 +284,27 @@ namespace vkt
 	{
 	}
 
-	std::vector<WaitData> SectorToImageEntity::Record(vk::CommandBuffer cmd)
+	void SectorToImageEntity::Record(vk::CommandBuffer cmd, SemaphoreWaits& waits)
 	{
 		srcVersion = srcSector->bufferAllocation->cmdManager.GetSubmitCount();
 
 		bufferImageCopy.bufferOffset = srcSector->allocationOffset;
-		vk::ImageMemoryBarrier imageMemoryBarrier(vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite, dstImageFormat,
-			vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage,
+		vk::ImageMemoryBarrier2 imageMemoryBarrier(
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eNone,
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+			dstImageFormat, vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage,
 			subresourceRange);
-		cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer,
-			vk::PipelineStageFlagBits::eTransfer,
-			{},
-			0, {},
-			0, {},
-			1, &imageMemoryBarrier);
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, 1, &imageMemoryBarrier));
 		cmd.copyBufferToImage(srcSector->bufferAllocation->bufferData.buffer, dstImage, vk::ImageLayout::eTransferDstOptimal, 1, &bufferImageCopy);
-		imageMemoryBarrier = vk::ImageMemoryBarrier(
-			vk::AccessFlagBits::eTransferWrite,
-			vk::AccessFlagBits::eNoneKHR,
-			vk::ImageLayout::eTransferDstOptimal,
-			dstImageFormat, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage,
+		//Later users outside of this submission are covered by the submissions timeline signal
+		imageMemoryBarrier = vk::ImageMemoryBarrier2(
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+			vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite,
+			vk::ImageLayout::eTransferDstOptimal, dstImageFormat, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage,
 			subresourceRange);
-		cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-			{},
-			0, {},
-			0, {},
-			1, &imageMemoryBarrier);
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, 1, &imageMemoryBarrier));
 
-		return { WaitData(srcSector->bufferAllocation->cmdManager.GetSubmitCountPtr(), srcSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer) };
+		MergeWait(waits, { srcSector->bufferAllocation->cmdManager.GetMainTimelineSignal().semaphore, srcVersion, vk::PipelineStageFlagBits2::eCopy });
 	}
 
 	bool SectorToImageEntity::NeedsRecording()
@@ -320,36 +324,23 @@ namespace vkt
 	{
 	}
 
-	std::vector<WaitData> ImageToImageEntity::Record(vk::CommandBuffer cmd)
+	void ImageToImageEntity::Record(vk::CommandBuffer cmd, SemaphoreWaits& waits)
 	{
-		vk::ImageMemoryBarrier srcImageTransition(vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferRead, srcImageLayout, vk::ImageLayout::eTransferSrcOptimal,
-			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage, subresourceRange);
-		vk::ImageMemoryBarrier dstImageTransition(vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite, dstImageLayout, vk::ImageLayout::eTransferDstOptimal,
-			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage, subresourceRange);
+		vk::ImageMemoryBarrier2 srcImageTransition(vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eNone, vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead,
+			srcImageLayout, vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage, subresourceRange);
+		vk::ImageMemoryBarrier2 dstImageTransition(vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eNone, vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+			dstImageLayout, vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage, subresourceRange);
 
-		vk::ImageMemoryBarrier srcImageDeTransition(vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eNoneKHR, vk::ImageLayout::eTransferSrcOptimal, srcImageLayout,
-			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage, subresourceRange);
-		vk::ImageMemoryBarrier dstImageDeTransition(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eNoneKHR, vk::ImageLayout::eTransferDstOptimal, dstImageLayout,
-			VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage, subresourceRange);
+		vk::ImageMemoryBarrier2 srcImageDeTransition(vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eNone, vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite,
+			vk::ImageLayout::eTransferSrcOptimal, srcImageLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcImage, subresourceRange);
+		vk::ImageMemoryBarrier2 dstImageDeTransition(vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite,
+			vk::ImageLayout::eTransferDstOptimal, dstImageLayout, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, dstImage, subresourceRange);
 
-		vk::ImageMemoryBarrier transitionsBarriers[] = { srcImageTransition, dstImageTransition };
-		cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer,
-			vk::PipelineStageFlagBits::eTransfer,
-			{},
-			0, {},
-			0, {},
-			2, transitionsBarriers);
+		vk::ImageMemoryBarrier2 transitionsBarriers[] = { srcImageTransition, dstImageTransition };
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, 2, transitionsBarriers));
 		cmd.copyImage(srcImage, vk::ImageLayout::eTransferSrcOptimal, dstImage, vk::ImageLayout::eTransferDstOptimal, 1, &imageCopy);
-		vk::ImageMemoryBarrier DeTransitionsBarriers[] = { srcImageDeTransition, dstImageDeTransition };
-
-		cmd.pipelineBarrier(
-			vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-			{},
-			0, {},
-			0, {},
-			2, DeTransitionsBarriers);
-		return {};
+		vk::ImageMemoryBarrier2 DeTransitionsBarriers[] = { srcImageDeTransition, dstImageDeTransition };
+		cmd.pipelineBarrier2(vk::DependencyInfo({}, 0, {}, 0, {}, 2, DeTransitionsBarriers));
 	}
 
 	bool ImageToImageEntity::NeedsRecording()
@@ -460,26 +451,25 @@ namespace vkt
 		return true;
 	}
 
-	std::vector<WaitData> TransferEntity::Record(vk::CommandBuffer cmd)
+	void TransferEntity::Record(vk::CommandBuffer cmd, SemaphoreWaits& waits)
 	{
 		assert(IsSectorToSector() || IsSectorToImage() || IsImageToSector() || IsImageToImage());
 		if (IsSectorToSector())
 		{
-			return AsSectorToSector().Record(cmd);
+			AsSectorToSector().Record(cmd, waits);
 		}
 		else if (IsSectorToImage())
 		{
-			return AsSectorToImage().Record(cmd);
+			AsSectorToImage().Record(cmd, waits);
 		}
 		else if (IsImageToSector())
 		{
-			return AsImageToSector().Record(cmd);
+			AsImageToSector().Record(cmd, waits);
 		}
 		else if (IsImageToImage())
 		{
-			return AsImageToImage().Record(cmd);
+			AsImageToImage().Record(cmd, waits);
 		}
-		return {};
 	}
 
 
@@ -602,26 +592,42 @@ namespace vkt
 
 
 
-	ToRamTransferExecutor::ToRamTransferExecutor(vk::Device deviceHandle, std::shared_ptr<SectorData> _stagingBuffer, void* _dst, WaitData _wait) :device(deviceHandle), stagingBuffer(_stagingBuffer), dst(_dst), waitData(_wait.waitValuePtr, _wait.waitSemaphore, vk::PipelineStageFlagBits::eTransfer) {}
+	ToRamTransferExecutor::ToRamTransferExecutor(vk::Device deviceHandle, std::shared_ptr<SectorData> _stagingBuffer, void* _dst, WaitData _wait) :device(deviceHandle), stagingBuffer(_stagingBuffer), dst(_dst), waitData(_wait.waitValuePtr, _wait.waitSemaphore, vk::PipelineStageFlagBits2::eCopy) {}
 	void ToRamTransferExecutor::Execute()
 	{
-		vk::SemaphoreWaitInfo waitInfo({}, 1, &waitData.waitSemaphore, waitData.waitValuePtr.get());
+		uint64_t value = std::atomic_ref<uint64_t>(*waitData.waitValuePtr).load(std::memory_order_acquire);
+		vk::SemaphoreWaitInfo waitInfo({}, 1, &waitData.waitSemaphore, &value);
 		auto res = device.waitSemaphores(waitInfo, UINT64_MAX);
 		CopyToRam(stagingBuffer, dst);
 	}
+	void ToRamTransferExecutor::ExecuteOnComplete(CompletionService& service, std::function<void()> callback)
+	{
+		auto staging = stagingBuffer;
+		auto destination = dst;
+		//The value usually is a submit count that other threads increment through atomic_ref
+		uint64_t value = std::atomic_ref<uint64_t>(*waitData.waitValuePtr).load(std::memory_order_acquire);
+		service.OnComplete(waitData.waitSemaphore, value, [staging, destination, callback]()
+			{
+				CopyToRam(staging, destination);
+				if (callback)
+				{
+					callback();
+				}
+			});
+	}
 
 
 
 
 	MemoryOperationsBuffer::MemoryOperationsBuffer(ObjectManager& _vom)
 		: vom(_vom), transferBuffer(_vom.GetDevice(), _vom.GetAllocator(), _vom.GetTransferQueue(), vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_CPU_ONLY),
-		cmdManager(_vom, _vom.GetTransferQueue(), true, vk::PipelineStageFlagBits::eTransfer)
+		cmdManager(_vom, _vom.GetTransferQueue(), true, vk::PipelineStageFlagBits2::eTransfer)
 	{
 		vom.SetTransferQueue(_vom.GetTransferQueue());
 	}
 	MemoryOperationsBuffer::MemoryOperationsBuffer(vk::Device deviceHandle, VmaAllocator allocatorHandle, QueueData transferQueueData)
 		: vom(deviceHandle), transferBuffer(deviceHandle, allocatorHandle, transferQueueData, vk::BufferUsageFlagBits::eStorageBuffer, VMA_MEMORY_USAGE_CPU_ONLY),
-		cmdManager(deviceHandle, transferQueueData, true, vk::PipelineStageFlagBits::eTransfer)
+		cmdManager(deviceHandle, transferQueueData, true, vk::PipelineStageFlagBits2::eTransfer)
 	{
 		assert(transferQueueData.queue != NULL);
 		vom.SetTransferQueue(transferQueueData);
@@ -749,7 +755,7 @@ namespace vkt
 		stagingBuffer->neededSize = src->neededSize;
 		transferBuffer.Update(true);
 		FindStep(transferData.EmplaceSectorToSector(src, stagingBuffer, src->neededSize));
-		return ToRamTransferExecutor(vom.GetDevice(), stagingBuffer, dst, WaitData(cmdManager.GetSubmitCountPtr(), cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer));
+		return ToRamTransferExecutor(vom.GetDevice(), stagingBuffer, dst, WaitData(cmdManager.GetSubmitCountPtr(), cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits2::eCopy));
 	}
 	void MemoryOperationsBuffer::SectorToSector(std::shared_ptr<SectorData> src, std::shared_ptr<SectorData> dst, uint64_t size)
 	{
@@ -806,11 +812,11 @@ namespace vkt
 		stagingBuffer->neededSize = reqs.size;
 		transferBuffer.Update(true);
 		FindStep(transferData.EmplaceImageToSector(srcImage, stagingBuffer, copyData, srcImageLayout, subresourceRange));
-		return ToRamTransferExecutor(vom.GetDevice(), stagingBuffer, dst, WaitData(cmdManager.GetSubmitCountPtr(), cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits::eTransfer));
+		return ToRamTransferExecutor(vom.GetDevice(), stagingBuffer, dst, WaitData(cmdManager.GetSubmitCountPtr(), cmdManager.GetMainTimelineSignal().semaphore, vk::PipelineStageFlagBits2::eCopy));
 	}
 	void MemoryOperationsBuffer::DependsOn(WaitData wait)
 	{
-		cmdManager.DependsOn({ wait });
+		cmdManager.syncManager.AttachWaitData(wait);
 	}
 	void MemoryOperationsBuffer::Clear(bool freeInternalBuffer)
 	{
@@ -824,7 +830,7 @@ namespace vkt
 		}
 	};
 
-	void MemoryOperationsBuffer::Execute(std::vector<WaitData> transientWaits, bool wait, bool useNormalSignal, bool useNormalWaits)
+	void MemoryOperationsBuffer::RecordTransfers(SemaphoreWaits& waits)
 	{
 		bool record = false;
 		for (size_t i = 0; i < transferData.Size(); i++)
@@ -836,8 +842,6 @@ namespace vkt
 			}
 		}
 
-		std::vector<WaitData> submitWaits;
-
 		if (record)
 		{
 			cmdManager.Reset();
@@ -847,41 +851,38 @@ namespace vkt
 			{
 				for (auto transferIndex : step.transferIndecies)
 				{
-					auto transfer = transferData[transferIndex];
-					auto waits = transfer.Record(cmd);
-					for (auto& wait : waits)
-					{
-						bool needsAdd = true;
-						for (auto& finalWait : submitWaits)
-						{
-							if (wait.waitSemaphore == finalWait.waitSemaphore)
-							{
-								needsAdd = false;
-								break;
-							}
-						}
-						if (needsAdd)
-						{
-							submitWaits.emplace_back(wait);
-						}
-					}
+					transferData[transferIndex].Record(cmd, waits);
 				}
-				vk::MemoryBarrier memoryBarrier(vk::AccessFlagBits::eNoneKHR, vk::AccessFlagBits::eTransferWrite);
-				cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-					{},
-					1, &memoryBarrier,
-					0, {},
-					0, {});
+				//The next step may read or overwrite what this step wrote
+				vk::MemoryBarrier2 memoryBarrier(
+					vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferWrite,
+					vk::PipelineStageFlagBits2::eCopy, vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite);
+				cmd.pipelineBarrier2(vk::DependencyInfo({}, 1, &memoryBarrier, 0, {}, 0, {}));
 			}
 			cmd.end();
 
 		}
+	}
 
-		submitWaits.insert(submitWaits.end(), transientWaits.begin(), transientWaits.end());
+	void MemoryOperationsBuffer::Execute(std::vector<WaitData> transientWaits, bool wait, bool useNormalSignal, bool useNormalWaits)
+	{
+		SemaphoreWaits submitWaits;
+		RecordTransfers(submitWaits);
 		cmdManager.DependsOn(submitWaits);
+		cmdManager.DependsOn(transientWaits);
 		cmdManager.Execute(true, wait, useNormalSignal, useNormalWaits);
 		cmdManager.ClearDepends();
 	}
+	void MemoryOperationsBuffer::Execute(SubmissionBatcher& batcher, std::vector<WaitData> transientWaits, bool useNormalSignal, bool useNormalWaits)
+	{
+		SemaphoreWaits submitWaits;
+		RecordTransfers(submitWaits);
+		cmdManager.DependsOn(submitWaits);
+		cmdManager.DependsOn(transientWaits);
+		//The wait values are captured by the batcher so the depends can be cleared right away
+		cmdManager.Execute(batcher, true, useNormalSignal, useNormalWaits);
+		cmdManager.ClearDepends();
+	}
 
 	void MemoryOperationsBuffer::WaitOn()
 	{
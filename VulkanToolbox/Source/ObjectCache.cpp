@@ -0,0 +1,144 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	static uint64_t FloatKey(float value)
+	{
+		return std::bit_cast<uint32_t>(value);
+	}
+
+	//The cache vom is made from the device alone so it does not hold on to the cache itself
+	ObjectCache::ObjectCache(ObjectManager& _vom)
+		: vom(_vom.GetDevice())
+	{
+	}
+	ObjectCache::ObjectCache(vk::Device deviceHandle)
+		: vom(deviceHandle)
+	{
+	}
+
+	vk::Sampler ObjectCache::GetSampler(const vk::SamplerCreateInfo& createInfo)
+	{
+		if (createInfo.pNext != nullptr)
+		{
+			return VK_NULL_HANDLE;
+		}
+		ObjectKey key = {
+			static_cast<uint64_t>(static_cast<VkSamplerCreateFlags>(createInfo.flags)),
+			static_cast<uint64_t>(createInfo.magFilter),
+			static_cast<uint64_t>(createInfo.minFilter),
+			static_cast<uint64_t>(createInfo.mipmapMode),
+			static_cast<uint64_t>(createInfo.addressModeU),
+			static_cast<uint64_t>(createInfo.addressModeV),
+			static_cast<uint64_t>(createInfo.addressModeW),
+			FloatKey(createInfo.mipLodBias),
+			createInfo.anisotropyEnable,
+			FloatKey(createInfo.maxAnisotropy),
+			createInfo.compareEnable,
+			static_cast<uint64_t>(createInfo.compareOp),
+			FloatKey(createInfo.minLod),
+			FloatKey(createInfo.maxLod),
+			static_cast<uint64_t>(createInfo.borderColor),
+			createInfo.unnormalizedCoordinates };
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& sampler = samplers[key];
+		if (sampler == VK_NULL_HANDLE)
+		{
+			sampler = vom.MakeImageSampler(createInfo);
+		}
+		return sampler;
+	}
+	vk::DescriptorSetLayout ObjectCache::GetDescriptorSetLayout(const vk::DescriptorSetLayoutCreateInfo& createInfo)
+	{
+		const vk::DescriptorBindingFlags* bindingFlags = nullptr;
+		if (createInfo.pNext != nullptr)
+		{
+			auto extension = static_cast<const vk::BaseInStructure*>(createInfo.pNext);
+			if (extension->sType != vk::StructureType::eDescriptorSetLayoutBindingFlagsCreateInfo || extension->pNext != nullptr)
+			{
+				return VK_NULL_HANDLE;
+			}
+			auto flagsInfo = static_cast<const vk::DescriptorSetLayoutBindingFlagsCreateInfo*>(createInfo.pNext);
+			if (flagsInfo->bindingCount != 0)
+			{
+				assert(flagsInfo->bindingCount == createInfo.bindingCount);
+				bindingFlags = flagsInfo->pBindingFlags;
+			}
+		}
+
+		std::vector<uint32_t> order(createInfo.bindingCount);
+		for (uint32_t i = 0; i < createInfo.bindingCount; i++)
+		{
+			order[i] = i;
+		}
+		std::sort(order.begin(), order.end(), [&createInfo](uint32_t a, uint32_t b) { return createInfo.pBindings[a].binding < createInfo.pBindings[b].binding; });
+
+		ObjectKey key = { static_cast<uint64_t>(static_cast<VkDescriptorSetLayoutCreateFlags>(createInfo.flags)), createInfo.bindingCount, bindingFlags != nullptr };
+		for (auto index : order)
+		{
+			auto& binding = createInfo.pBindings[index];
+			key.emplace_back(binding.binding);
+			key.emplace_back(static_cast<uint64_t>(binding.descriptorType));
+			key.emplace_back(binding.descriptorCount);
+			key.emplace_back(static_cast<uint64_t>(static_cast<VkShaderStageFlags>(binding.stageFlags)));
+			key.emplace_back(bindingFlags != nullptr ? static_cast<uint64_t>(static_cast<VkDescriptorBindingFlags>(bindingFlags[index])) : 0);
+			//Immutable samplers are part of the layout, the sampler cache makes identical ones the same handle
+			bool immutable = binding.pImmutableSamplers != nullptr;
+			key.emplace_back(immutable);
+			for (uint32_t i = 0; immutable && i < binding.descriptorCount; i++)
+			{
+				key.emplace_back((uint64_t)static_cast<VkSampler>(binding.pImmutableSamplers[i]));
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& layout = setLayouts[key];
+		if (layout == VK_NULL_HANDLE)
+		{
+			layout = vom.MakeDescriptorSetLayout(createInfo);
+		}
+		return layout;
+	}
+	vk::PipelineLayout ObjectCache::GetPipelineLayout(const vk::PipelineLayoutCreateInfo& createInfo)
+	{
+		if (createInfo.pNext != nullptr)
+		{
+			return VK_NULL_HANDLE;
+		}
+		//Set layouts from the set layout cache are already deduplicated, so their handles identify them
+		ObjectKey key = { static_cast<uint64_t>(static_cast<VkPipelineLayoutCreateFlags>(createInfo.flags)), createInfo.setLayoutCount, createInfo.pushConstantRangeCount };
+		for (uint32_t i = 0; i < createInfo.setLayoutCount; i++)
+		{
+			key.emplace_back((uint64_t)static_cast<VkDescriptorSetLayout>(createInfo.pSetLayouts[i]));
+		}
+		for (uint32_t i = 0; i < createInfo.pushConstantRangeCount; i++)
+		{
+			auto& range = createInfo.pPushConstantRanges[i];
+			key.emplace_back(static_cast<uint64_t>(static_cast<VkShaderStageFlags>(range.stageFlags)));
+			key.emplace_back(range.offset);
+			key.emplace_back(range.size);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& layout = pipelineLayouts[key];
+		if (layout == VK_NULL_HANDLE)
+		{
+			layout = vom.MakePipelineLayout(createInfo);
+		}
+		return layout;
+	}
+	void ObjectCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		samplers.clear();
+		setLayouts.clear();
+		pipelineLayouts.clear();
+		vom.DestroyAll();
+	}
+	uint64_t ObjectCache::Count()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return samplers.size() + setLayouts.size() + pipelineLayouts.size();
+	}
+}
@@ -1,16 +1,28 @@
 #include "../Headers/VulkanToolbox.hpp"
-#include <fstream>
 
 namespace vkt
 {
 		
-	WaitData::WaitData(std::shared_ptr<uint64_t> _waitValuePtr, vk::Semaphore _waitSemaphore, vk::PipelineStageFlags _waitStage)
+	WaitData::WaitData(std::shared_ptr<uint64_t> _waitValuePtr, vk::Semaphore _waitSemaphore, vk::PipelineStageFlags2 _waitStage)
 	{
 		waitValuePtr = _waitValuePtr;
 		waitSemaphore = _waitSemaphore;
 		waitStage = _waitStage;
 	}
 
+	std::mutex& QueueMutex(vk::Queue queue)
+	{
+		static std::mutex registryMutex;
+		static std::unordered_map<VkQueue, std::unique_ptr<std::mutex>> queueMutexes;
+		std::lock_guard<std::mutex> lock(registryMutex);
+		auto& queueMutex = queueMutexes[static_cast<VkQueue>(queue)];
+		if (queueMutex == nullptr)
+		{
+			queueMutex = std::make_unique<std::mutex>();
+		}
+		return *queueMutex;
+	}
+
 
 
 	
@@ -49,6 +61,10 @@ namespace vkt
 	ObjectManager::ObjectManager(ObjectManager& _vom)
 	{
 		SetDevice(_vom.GetDevice());
+		enabledFeatures = _vom.enabledFeatures;
+		shaderCache = _vom.shaderCache;
+		pipelineCache = _vom.pipelineCache;
+		objectCache = _vom.objectCache;
 	}
 
 
@@ -201,6 +217,14 @@ namespace vkt
 		assert(_generalQueue.queue != NULL);
 		generalQueue = _generalQueue;
 	}
+	EnabledFeatures ObjectManager::GetEnabledFeatures()
+	{
+		return enabledFeatures;
+	}
+	void ObjectManager::SetEnabledFeatures(EnabledFeatures _enabledFeatures)
+	{
+		enabledFeatures = _enabledFeatures;
+	}
 
 	vk::Semaphore ObjectManager::MakeSemaphore(bool manage)
 	{
@@ -264,6 +288,10 @@ namespace vkt
 	}
 	vk::Pipeline ObjectManager::MakePipeline(vk::PipelineCache cache, vk::GraphicsPipelineCreateInfo createInfo, bool manage)
 	{
+		if (cache == VK_NULL_HANDLE && pipelineCache != nullptr)
+		{
+			cache = pipelineCache->GetCache();
+		}
 		vk::ResultValue<vk::Pipeline> pipeline = GetDevice().createGraphicsPipeline(cache, createInfo);
 		if (manage)
 		{
@@ -273,6 +301,10 @@ namespace vkt
 	}
 	vk::Pipeline ObjectManager::MakePipeline(vk::PipelineCache cache, vk::ComputePipelineCreateInfo createInfo, bool manage)
 	{
+		if (cache == VK_NULL_HANDLE && pipelineCache != nullptr)
+		{
+			cache = pipelineCache->GetCache();
+		}
 		vk::ResultValue<vk::Pipeline> pipeline = GetDevice().createComputePipeline(cache, createInfo);
 		if (manage)
 		{
@@ -280,8 +312,25 @@ namespace vkt
 		}
 		return pipeline.value;
 	}
+	vk::PipelineCache ObjectManager::MakePipelineCache(vk::PipelineCacheCreateInfo createInfo, bool manage)
+	{
+		auto cache = GetDevice().createPipelineCache(createInfo);
+		if (manage)
+		{
+			Manage(cache);
+		}
+		return cache;
+	}
 	vk::PipelineLayout ObjectManager::MakePipelineLayout(vk::PipelineLayoutCreateInfo createInfo, bool manage)
 	{
+		if (objectCache != nullptr)
+		{
+			auto cached = objectCache->GetPipelineLayout(createInfo);
+			if (cached != VK_NULL_HANDLE)
+			{
+				return cached;
+			}
+		}
 		auto layout = GetDevice().createPipelineLayout(createInfo);
 		if (manage)
 		{
@@ -318,6 +367,14 @@ namespace vkt
 	}
 	vk::DescriptorSetLayout ObjectManager::MakeDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo createInfo, bool manage)
 	{
+		if (objectCache != nullptr)
+		{
+			auto cached = objectCache->GetDescriptorSetLayout(createInfo);
+			if (cached != VK_NULL_HANDLE)
+			{
+				return cached;
+			}
+		}
 		auto layout = GetDevice().createDescriptorSetLayout(createInfo);
 		if (manage)
 		{
@@ -325,6 +382,15 @@ namespace vkt
 		}
 		return layout;
 	}
+	vk::DescriptorUpdateTemplate ObjectManager::MakeDescriptorUpdateTemplate(vk::DescriptorUpdateTemplateCreateInfo createInfo, bool manage)
+	{
+		auto updateTemplate = GetDevice().createDescriptorUpdateTemplate(createInfo);
+		if (manage)
+		{
+			Manage(updateTemplate);
+		}
+		return updateTemplate;
+	}
 	std::vector<vk::DescriptorSet> ObjectManager::MakeDescriptorSets(vk::DescriptorSetAllocateInfo allocateInfo)
 	{
 		return GetDevice().allocateDescriptorSets(allocateInfo);
@@ -363,13 +429,15 @@ namespace vkt
 		if (mount)
 		{
 			allocator = allocatorHandle;
+			allocatorFlags = createInfo.flags;
 		}
 		return allocatorHandle;
 	}
-	VmaAllocator ObjectManager::MakeAllocator(uint32_t apiVersion, bool mount, bool manage)
+	VmaAllocator ObjectManager::MakeAllocator(uint32_t apiVersion, bool mount, bool manage, VmaAllocatorCreateFlags flags)
 	{
 
 		VmaAllocatorCreateInfo allocatorCreateInfo = {};
+		allocatorCreateInfo.flags = flags;
 		allocatorCreateInfo.vulkanApiVersion = apiVersion;
 		allocatorCreateInfo.physicalDevice = GetPhysicalDevice();
 		allocatorCreateInfo.device = GetDevice();
@@ -383,12 +451,18 @@ namespace vkt
 		if (mount)
 		{
 			allocator = allocatorHandle;
+			allocatorFlags = flags;
 		}
 		return allocatorHandle;
 	}
-	void ObjectManager::SetAllocator(VmaAllocator allocatorHandle)
+	void ObjectManager::SetAllocator(VmaAllocator allocatorHandle, VmaAllocatorCreateFlags flags)
 	{
 		allocator = allocatorHandle;
+		allocatorFlags = flags;
+	}
+	VmaAllocatorCreateFlags ObjectManager::GetAllocatorFlags()
+	{
+		return allocatorFlags;
 	}
 	VmaBuffer ObjectManager::VmaMakeBuffer(vk::BufferCreateInfo bufferInfo, VmaAllocationCreateInfo allocationCreateInfo, bool manage)
 	{
@@ -423,30 +497,36 @@ namespace vkt
 			auto pool = MakeCommandPool(vk::CommandPoolCreateInfo({}, GetGraphicsQueue().index), false);
 			auto cmd = MakeCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1))[0];
 			cmd.begin(vk::CommandBufferBeginInfo());
+			//The image has no prior contents so there is nothing to wait on, its first user is unknown so every later stage waits on the transition
 			TransitionImages(
 				cmd,
-				{ vk::ImageMemoryBarrier(
-					vk::AccessFlagBits::eNone,
-					vk::AccessFlagBits::eMemoryWrite,
+				{ vk::ImageMemoryBarrier2(
+					vk::PipelineStageFlagBits2::eNone,
+					vk::AccessFlagBits2::eNone,
+					vk::PipelineStageFlagBits2::eAllCommands,
+					vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
 					vk::ImageLayout::eUndefined,
 					imageInfo.initialLayout,
 					VK_QUEUE_FAMILY_IGNORED,
 					VK_QUEUE_FAMILY_IGNORED,
 					imageData.image,
-					viewInfo.subresourceRange) },
-				vk::PipelineStageFlagBits::eAllCommands,
-				vk::PipelineStageFlagBits::eAllCommands);
+					viewInfo.subresourceRange) });
 			cmd.end();
 			auto fence = MakeFence(false, false);
-			vk::SubmitInfo submit(
+			vk::CommandBufferSubmitInfo cmdInfo(cmd);
+			vk::SubmitInfo2 submit(
 				{},
 				{},
 				{},
 				1,
-				&cmd,
+				&cmdInfo,
 				{},
 				{});
-			auto res = GetGraphicsQueue().queue.submit(1, &submit, fence);
+			vk::Result res;
+			{
+				std::lock_guard<std::mutex> lock(QueueMutex(GetGraphicsQueue().queue));
+				res = GetGraphicsQueue().queue.submit2(1, &submit, fence);
+			}
 			res = GetDevice().waitForFences(1, &fence, VK_TRUE, UINT64_MAX);
 			GetDevice().destroyFence(fence);
 			GetDevice().destroyCommandPool(pool);
@@ -458,8 +538,33 @@ namespace vkt
 		return imageData;
 
 	}
+	VmaImage ObjectManager::VmaMakeImage(ImmediateSubmitContext& context, vk::ImageCreateInfo imageInfo, vk::ImageViewCreateInfo viewInfo, VmaAllocationCreateInfo allocationCreateInfo, bool manage)
+	{
+		auto imageData = VmaMakeImage(imageInfo, viewInfo, allocationCreateInfo, false, manage);
+		context.Transition(
+			{ vk::ImageMemoryBarrier2(
+				vk::PipelineStageFlagBits2::eNone,
+				vk::AccessFlagBits2::eNone,
+				vk::PipelineStageFlagBits2::eAllCommands,
+				vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+				vk::ImageLayout::eUndefined,
+				imageInfo.initialLayout,
+				VK_QUEUE_FAMILY_IGNORED,
+				VK_QUEUE_FAMILY_IGNORED,
+				imageData.image,
+				viewInfo.subresourceRange) });
+		return imageData;
+	}
 	vk::Sampler ObjectManager::MakeImageSampler(vk::SamplerCreateInfo createInfo, bool manage)
 	{
+		if (objectCache != nullptr)
+		{
+			auto cached = objectCache->GetSampler(createInfo);
+			if (cached != VK_NULL_HANDLE)
+			{
+				return cached;
+			}
+		}
 		vk::Sampler sampler = GetDevice().createSampler(createInfo);
 		if (manage)
 		{
@@ -467,53 +572,69 @@ namespace vkt
 		}
 		return sampler;
 	}
+	vk::QueryPool ObjectManager::MakeQueryPool(vk::QueryPoolCreateInfo createInfo, bool manage)
+	{
+		vk::QueryPool queryPool = GetDevice().createQueryPool(createInfo);
+		if (manage)
+		{
+			Manage(queryPool);
+		}
+		return queryPool;
+	}
 
 
-	void ObjectManager::TransitionImages(vk::CommandBuffer cmd, std::vector<vk::ImageMemoryBarrier> imageTransitions, vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage)
+	void ObjectManager::TransitionImages(vk::CommandBuffer cmd, std::vector<vk::ImageMemoryBarrier2> imageTransitions)
 	{
-		cmd.pipelineBarrier(
-			srcStage,
-			dstStage,
+		//Every barrier carries its own stages so transitions of unrelated images can share one call
+		cmd.pipelineBarrier2(vk::DependencyInfo(
 			{},
 			0,
 			{},
 			0,
 			{},
 			imageTransitions.size(),
-			imageTransitions.data());
+			imageTransitions.data()));
 	}
-	void ObjectManager::TransitionImages(std::vector<vk::ImageMemoryBarrier> imageTransitions, vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage)
+	void ObjectManager::TransitionImages(std::vector<vk::ImageMemoryBarrier2> imageTransitions)
 	{
 		auto pool = MakeCommandPool(vk::CommandPoolCreateInfo({}, GetGraphicsQueue().index), false);
 		auto cmd = MakeCommandBuffers(vk::CommandBufferAllocateInfo(pool, vk::CommandBufferLevel::ePrimary, 1))[0];
 		cmd.begin(vk::CommandBufferBeginInfo());
-		TransitionImages(cmd, imageTransitions, srcStage, dstStage);
+		TransitionImages(cmd, imageTransitions);
 		cmd.end();
 		auto fence = MakeFence(false, false);
-		vk::SubmitInfo submit(
+		vk::CommandBufferSubmitInfo cmdInfo(cmd);
+		vk::SubmitInfo2 submit(
 			{},
 			{},
 			{},
 			1,
-			&cmd,
+			&cmdInfo,
 			{},
 			{});
-		auto res = GetGraphicsQueue().queue.submit(1, &submit, fence);
+		vk::Result res;
+		{
+			std::lock_guard<std::mutex> lock(QueueMutex(GetGraphicsQueue().queue));
+			res = GetGraphicsQueue().queue.submit2(1, &submit, fence);
+		}
 		res = GetDevice().waitForFences(1, &fence, VK_TRUE, UINT64_MAX);
 		GetDevice().destroyFence(fence);
 		GetDevice().destroyCommandPool(pool);
 	}
+	void ObjectManager::TransitionImages(ImmediateSubmitContext& context, std::vector<vk::ImageMemoryBarrier2> imageTransitions)
+	{
+		context.Transition(imageTransitions);
+	}
 
 	vk::ShaderModule ObjectManager::MakeShaderModule(const char* shaderPath, bool manage)
 	{
-		std::ifstream file(shaderPath, std::ios::ate | std::ios::binary);
-		assert(file.is_open());
-		size_t fileSize = (size_t)file.tellg();
-		std::vector<char> buffer(fileSize);
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-		file.close();
-		vk::ShaderModuleCreateInfo moduleCreateInfo({}, buffer.size(), reinterpret_cast<const uint32_t*>(buffer.data()));
+		if (shaderCache != nullptr)
+		{
+			return shaderCache->Get(shaderPath);
+		}
+		MappedFile file(shaderPath);
+		assert(file.IsOpen());
+		vk::ShaderModuleCreateInfo moduleCreateInfo({}, file.Size(), reinterpret_cast<const uint32_t*>(file.Data()));
 		auto module = GetDevice().createShaderModule(moduleCreateInfo);
 		if (manage)
 		{
@@ -521,6 +642,30 @@ namespace vkt
 		}
 		return module;
 	}
+	void ObjectManager::SetShaderCache(std::shared_ptr<ShaderCache> cache)
+	{
+		shaderCache = cache;
+	}
+	std::shared_ptr<ShaderCache> ObjectManager::GetShaderCache()
+	{
+		return shaderCache;
+	}
+	void ObjectManager::SetPipelineCache(std::shared_ptr<PersistentPipelineCache> cache)
+	{
+		pipelineCache = cache;
+	}
+	std::shared_ptr<PersistentPipelineCache> ObjectManager::GetPipelineCache()
+	{
+		return pipelineCache;
+	}
+	void ObjectManager::SetObjectCache(std::shared_ptr<ObjectCache> cache)
+	{
+		objectCache = cache;
+	}
+	std::shared_ptr<ObjectCache> ObjectManager::GetObjectCache()
+	{
+		return objectCache;
+	}
 	vk::Framebuffer ObjectManager::MakeFramebuffer(vk::FramebufferCreateInfo createInfo, bool manage)
 	{
 		auto frame = GetDevice().createFramebuffer(createInfo);
@@ -531,326 +676,464 @@ namespace vkt
 		return frame;
 	}
 
-	void ObjectManager::Manage(vk::Framebuffer frame)
+	ManagedObject ObjectManager::Describe(vk::Semaphore semaphore)
 	{
-		framebuffersToDestroy.emplace_back(frame);
+		return ManagedObject{ ObjectType::Semaphore, (uint64_t)static_cast<VkSemaphore>(semaphore) };
 	}
-	void ObjectManager::Manage(vk::ShaderModule module)
+	ManagedObject ObjectManager::Describe(vk::Fence fence)
 	{
-		assert(module != NULL);
-		shaderModulesToDestroy.emplace_back(module);
+		return ManagedObject{ ObjectType::Fence, (uint64_t)static_cast<VkFence>(fence) };
 	}
-	void ObjectManager::Manage(vk::Semaphore semaphore)
+	ManagedObject ObjectManager::Describe(vk::CommandPool commandPool)
 	{
-		assert(semaphore != NULL);
-		semaphoresToDestroy.emplace_back(semaphore);
+		return ManagedObject{ ObjectType::CommandPool, (uint64_t)static_cast<VkCommandPool>(commandPool) };
 	}
-	void ObjectManager::Manage(vk::Fence fence)
+	ManagedObject ObjectManager::Describe(vk::Framebuffer framebuffer)
 	{
-		assert(fence != NULL);
-		fencesToDestroy.emplace_back(fence);
+		return ManagedObject{ ObjectType::Framebuffer, (uint64_t)static_cast<VkFramebuffer>(framebuffer) };
 	}
-	void ObjectManager::Manage(vk::CommandPool commandPool)
+	ManagedObject ObjectManager::Describe(vk::RenderPass renderPass)
 	{
-		assert(commandPool != NULL);
-		commandPoolsToDestroy.emplace_back(commandPool);
+		return ManagedObject{ ObjectType::RenderPass, (uint64_t)static_cast<VkRenderPass>(renderPass) };
 	}
-	void ObjectManager::Manage(vk::RenderPass renderPass)
+	ManagedObject ObjectManager::Describe(vk::ShaderModule module)
 	{
-		assert(renderPass != NULL);
-		renderPassesToDestroy.emplace_back(renderPass);
+		return ManagedObject{ ObjectType::ShaderModule, (uint64_t)static_cast<VkShaderModule>(module) };
 	}
-	void ObjectManager::Manage(vk::Pipeline pipeline)
+	ManagedObject ObjectManager::Describe(vk::Pipeline pipeline)
 	{
-		assert(pipeline != NULL);
-		pipelineToDestroy.emplace_back(pipeline);
+		return ManagedObject{ ObjectType::Pipeline, (uint64_t)static_cast<VkPipeline>(pipeline) };
 	}
-	void ObjectManager::Manage(vk::PipelineLayout layout)
+	ManagedObject ObjectManager::Describe(vk::PipelineCache cache)
 	{
-		assert(layout != NULL);
-		pipelineLayoutsToDestroy.emplace_back(layout);
+		return ManagedObject{ ObjectType::PipelineCache, (uint64_t)static_cast<VkPipelineCache>(cache) };
 	}
-	void ObjectManager::Manage(vk::Buffer buffer)
+	ManagedObject ObjectManager::Describe(vk::PipelineLayout layout)
 	{
-		assert(buffer != NULL);
-		buffersToDestroy.emplace_back(buffer);
+		return ManagedObject{ ObjectType::PipelineLayout, (uint64_t)static_cast<VkPipelineLayout>(layout) };
 	}
-	void ObjectManager::Manage(vk::DeviceMemory aloc)
+	ManagedObject ObjectManager::Describe(vk::Buffer buffer)
 	{
-		assert(aloc != NULL);
-		memoryAllocationsToDestroy.emplace_back(aloc);
+		return ManagedObject{ ObjectType::Buffer, (uint64_t)static_cast<VkBuffer>(buffer) };
 	}
-	void ObjectManager::Manage(vk::Device device)
+	ManagedObject ObjectManager::Describe(vk::DeviceMemory memory)
 	{
-		assert(device != NULL);
-		devicesToDestroy.emplace_back(device);
+		return ManagedObject{ ObjectType::DeviceMemory, (uint64_t)static_cast<VkDeviceMemory>(memory) };
 	}
-	void ObjectManager::Manage(vk::DescriptorPool pool)
+	ManagedObject ObjectManager::Describe(vk::DescriptorPool pool)
 	{
-		assert(pool != NULL);
-		descriptorPoolsToDestroy.emplace_back(pool);
+		return ManagedObject{ ObjectType::DescriptorPool, (uint64_t)static_cast<VkDescriptorPool>(pool) };
 	}
-	void ObjectManager::Manage(vk::DescriptorSetLayout layout)
+	ManagedObject ObjectManager::Describe(vk::DescriptorSetLayout layout)
 	{
-		assert(layout != NULL);
-		descriptorSetLayoutsToDestroy.emplace_back(layout);
+		return ManagedObject{ ObjectType::DescriptorSetLayout, (uint64_t)static_cast<VkDescriptorSetLayout>(layout) };
 	}
-	void ObjectManager::Manage(vk::Instance instance)
+	ManagedObject ObjectManager::Describe(vk::DescriptorUpdateTemplate updateTemplate)
 	{
-		assert(instance != NULL);
-		instancesToDestroy.emplace_back(instance);
+		return ManagedObject{ ObjectType::DescriptorUpdateTemplate, (uint64_t)static_cast<VkDescriptorUpdateTemplate>(updateTemplate) };
 	}
-	void ObjectManager::Manage(vk::SurfaceKHR surface)
+	ManagedObject ObjectManager::Describe(vk::Sampler sampler)
 	{
-		assert(surface != NULL);
-		surfacesToDestroy.emplace_back(surface);
+		return ManagedObject{ ObjectType::Sampler, (uint64_t)static_cast<VkSampler>(sampler) };
 	}
-	void ObjectManager::Manage(SwapchainData swapchainData)
+	ManagedObject ObjectManager::Describe(vk::QueryPool queryPool)
 	{
-		assert(swapchainData.swapchain != NULL);
-		swapchainsToDestroy.emplace_back(swapchainData.swapchain);
+		return ManagedObject{ ObjectType::QueryPool, (uint64_t)static_cast<VkQueryPool>(queryPool) };
 	}
-	void ObjectManager::Manage(vk::Image image)
+	ManagedObject ObjectManager::Describe(vk::Image image)
 	{
-		assert(image != NULL);
-		imagesToDestroy.emplace_back(image);
+		return ManagedObject{ ObjectType::Image, (uint64_t)static_cast<VkImage>(image) };
 	}
-	void ObjectManager::Manage(vk::ImageView imageView)
+	ManagedObject ObjectManager::Describe(vk::ImageView imageView)
 	{
-		assert(imageView != NULL);
-		imageViewsToDestroy.emplace_back(imageView);
+		return ManagedObject{ ObjectType::ImageView, (uint64_t)static_cast<VkImageView>(imageView) };
 	}
-	void ObjectManager::Manage(VmaAllocator allocator)
+	ManagedObject ObjectManager::Describe(VmaBuffer buffer)
 	{
-		assert(allocator != NULL);
-
-		allocatorsToDestroy.emplace_back(allocator);
+		return ManagedObject{ ObjectType::VmaBuffer, (uint64_t)static_cast<VkBuffer>(buffer.buffer), buffer.allocation };
 	}
-	void ObjectManager::Manage(VmaBuffer buffer)
+	ManagedObject ObjectManager::Describe(VmaImage image)
 	{
-		assert(buffer.buffer != NULL);
-
-		vmaBuffersToDestroy.emplace_back(buffer);
+		return ManagedObject{ ObjectType::VmaImage, (uint64_t)static_cast<VkImage>(image.image), image.allocation };
 	}
-	void ObjectManager::Manage(VmaImage image)
+	ManagedObject ObjectManager::Describe(VmaAllocator allocator)
 	{
-		assert(image.image != NULL);
-
-		vmaImagesToDestroy.emplace_back(image);
+		return ManagedObject{ ObjectType::VmaAllocator, (uint64_t)allocator };
+	}
+	ManagedObject ObjectManager::Describe(vk::SwapchainKHR swapchain)
+	{
+		return ManagedObject{ ObjectType::Swapchain, (uint64_t)static_cast<VkSwapchainKHR>(swapchain) };
+	}
+	ManagedObject ObjectManager::Describe(SwapchainData swapchainData)
+	{
+		return Describe(swapchainData.swapchain);
+	}
+	ManagedObject ObjectManager::Describe(vk::Device device)
+	{
+		return ManagedObject{ ObjectType::Device, (uint64_t)static_cast<VkDevice>(device) };
+	}
+	ManagedObject ObjectManager::Describe(vk::SurfaceKHR surface)
+	{
+		return ManagedObject{ ObjectType::Surface, (uint64_t)static_cast<VkSurfaceKHR>(surface) };
 	}
-	void ObjectManager::Manage(vk::Sampler sampler)
+	ManagedObject ObjectManager::Describe(vk::Instance instance)
 	{
-		assert(sampler != NULL);
-		samplersToDestroy.emplace_back(sampler);
+		return ManagedObject{ ObjectType::Instance, (uint64_t)static_cast<VkInstance>(instance) };
 	}
 
-	void ObjectManager::DestroyType(vk::Framebuffer)
+	uint32_t ObjectManager::ShardIndex(ObjectType type, uint64_t handle)
 	{
-		while (!framebuffersToDestroy.empty())
-		{
-			device.destroyFramebuffer(framebuffersToDestroy.back());
-			framebuffersToDestroy.pop_back();
-		}
+		//Handles are mostly aligned pointers, so their bits are mixed before picking a shard
+		uint64_t mixed = (handle ^ static_cast<uint64_t>(type)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<uint32_t>(mixed >> 32) % RegistryShardCount;
 	}
-	void ObjectManager::DestroyType(vk::ShaderModule)
+	static bool SlotAlive(const RegistryShard& shard, ObjectHandle handle)
 	{
-		while (!shaderModulesToDestroy.empty())
-		{
-			device.destroyShaderModule(shaderModulesToDestroy.back());
-			shaderModulesToDestroy.pop_back();
-		}
+		return handle.slot < shard.slotGenerations.size() && shard.slotGenerations[handle.slot] == handle.generation && shard.slotIndices[handle.slot] != UINT32_MAX;
 	}
-	void ObjectManager::DestroyType(vk::Semaphore)
+	ObjectHandle ObjectManager::Register(ManagedObject object)
 	{
-		while (!semaphoresToDestroy.empty())
+		assert(object.handle != 0);
+		uint32_t shardIndex = ShardIndex(object.type, object.handle);
+		auto& shard = shards[shardIndex];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto& lookup = shard.slotLookup[static_cast<size_t>(object.type)];
+		auto found = lookup.find(object.handle);
+		if (found != lookup.end())
 		{
-			GetDevice().destroySemaphore(semaphoresToDestroy.front());
-			semaphoresToDestroy.pop_front();
+			return ObjectHandle{ found->second, shard.slotGenerations[found->second], shardIndex };
 		}
-	}
-	void ObjectManager::DestroyType(vk::Fence)
-	{
-		while (!fencesToDestroy.empty())
+
+		uint32_t slot;
+		if (!shard.freeSlots.empty())
 		{
-			GetDevice().destroyFence(fencesToDestroy.front());
-			fencesToDestroy.pop_front();
+			slot = shard.freeSlots.back();
+			shard.freeSlots.pop_back();
 		}
-	}
-	void ObjectManager::DestroyType(vk::CommandPool)
-	{
-		while (!commandPoolsToDestroy.empty())
+		else
 		{
-			GetDevice().destroyCommandPool(commandPoolsToDestroy.front());
-			commandPoolsToDestroy.pop_front();
+			slot = static_cast<uint32_t>(shard.slotIndices.size());
+			shard.slotIndices.emplace_back(0);
+			shard.slotGenerations.emplace_back(0);
 		}
-	}
-	void ObjectManager::DestroyType(vk::RenderPass)
-	{
-		while (!renderPassesToDestroy.empty())
+		object.tag = currentTag.load(std::memory_order_relaxed);
+		object.slot = slot;
+		shard.slotIndices[slot] = static_cast<uint32_t>(shard.objects.size());
+		shard.objects.emplace_back(object);
+		lookup.emplace(object.handle, slot);
+		return ObjectHandle{ slot, shard.slotGenerations[slot], shardIndex };
+	}
+	ObjectHandle ObjectManager::Find(ObjectType type, uint64_t handle)
+	{
+		uint32_t shardIndex = ShardIndex(type, handle);
+		auto& shard = shards[shardIndex];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto& lookup = shard.slotLookup[static_cast<size_t>(type)];
+		auto found = lookup.find(handle);
+		if (found == lookup.end())
 		{
-			GetDevice().destroyRenderPass(renderPassesToDestroy.front());
-			renderPassesToDestroy.pop_front();
+			return ObjectHandle();
 		}
+		return ObjectHandle{ found->second, shard.slotGenerations[found->second], shardIndex };
 	}
-	void ObjectManager::DestroyType(vk::Pipeline)
+	bool ObjectManager::IsValid(ObjectHandle handle)
 	{
-		while (!pipelineToDestroy.empty())
+		if (handle.shard >= RegistryShardCount)
 		{
-			GetDevice().destroyPipeline(pipelineToDestroy.front());
-			pipelineToDestroy.pop_front();
+			return false;
 		}
+		auto& shard = shards[handle.shard];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		return SlotAlive(shard, handle);
 	}
-	void ObjectManager::DestroyType(vk::PipelineLayout)
+	bool ObjectManager::Remove(ObjectHandle handle, ManagedObject* removed)
 	{
-		while (!pipelineLayoutsToDestroy.empty())
+		if (handle.shard >= RegistryShardCount)
 		{
-			GetDevice().destroyPipelineLayout(pipelineLayoutsToDestroy.back());
-			pipelineLayoutsToDestroy.pop_back();
+			return false;
 		}
-	}
-	void ObjectManager::DestroyType(vk::Buffer)
-	{
-		while (!buffersToDestroy.empty())
+		auto& shard = shards[handle.shard];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (!SlotAlive(shard, handle))
 		{
-			GetDevice().destroyBuffer(buffersToDestroy.front());
-			buffersToDestroy.pop_front();
+			return false;
 		}
+		RemoveSlot(shard, handle.slot, removed);
+		return true;
 	}
-	void ObjectManager::DestroyType(vk::DeviceMemory)
+	void ObjectManager::RemoveSlot(RegistryShard& shard, uint32_t slot, ManagedObject* removed)
 	{
-		while (!memoryAllocationsToDestroy.empty())
+		uint32_t index = shard.slotIndices[slot];
+		if (removed != nullptr)
 		{
-			GetDevice().freeMemory(memoryAllocationsToDestroy.front());
-			memoryAllocationsToDestroy.pop_front();
+			*removed = shard.objects[index];
 		}
-	}
-	void ObjectManager::DestroyType(vk::Device)
-	{
-		while (!devicesToDestroy.empty())
+		shard.slotLookup[static_cast<size_t>(shard.objects[index].type)].erase(shard.objects[index].handle);
+		shard.objects[index] = shard.objects.back();
+		shard.slotIndices[shard.objects[index].slot] = index;
+		shard.objects.pop_back();
+		shard.slotIndices[slot] = UINT32_MAX;
+		shard.slotGenerations[slot]++;
+		shard.freeSlots.emplace_back(slot);
+	}
+	template<typename Predicate>
+	void ObjectManager::TakeObjects(Predicate predicate, std::vector<ManagedObject>& taken)
+	{
+		for (auto& shard : shards)
 		{
-			devicesToDestroy.back().waitIdle();
-			devicesToDestroy.back().destroy();
-			devicesToDestroy.pop_back();
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			//Walking backwards keeps the swap removal from skipping objects
+			for (size_t i = shard.objects.size(); i > 0; i--)
+			{
+				if (i - 1 < shard.objects.size() && predicate(shard.objects[i - 1]))
+				{
+					taken.emplace_back();
+					RemoveSlot(shard, shard.objects[i - 1].slot, &taken.back());
+				}
+			}
 		}
 	}
-	void ObjectManager::DestroyType(vk::DescriptorPool)
+	void ObjectManager::SetObjectTag(ObjectHandle handle, uint32_t tag)
 	{
-		while (!descriptorPoolsToDestroy.empty())
+		if (handle.shard >= RegistryShardCount)
 		{
-			GetDevice().destroyDescriptorPool(descriptorPoolsToDestroy.front());
-			descriptorPoolsToDestroy.pop_front();
+			return;
 		}
-	}
-	void ObjectManager::DestroyType(vk::DescriptorSetLayout)
-	{
-		while (!descriptorSetLayoutsToDestroy.empty())
+		auto& shard = shards[handle.shard];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (SlotAlive(shard, handle))
 		{
-			GetDevice().destroyDescriptorSetLayout(descriptorSetLayoutsToDestroy.front());
-			descriptorSetLayoutsToDestroy.pop_front();
+			shard.objects[shard.slotIndices[handle.slot]].tag = tag;
 		}
 	}
-	void ObjectManager::DestroyType(vk::Instance)
+	void ObjectManager::Destroy(ObjectHandle handle)
 	{
-		while (!instancesToDestroy.empty())
+		//The object leaves the registry under the shard lock but is destroyed after it is released
+		ManagedObject object;
+		if (Remove(handle, &object))
 		{
-			instancesToDestroy.front().destroy();
-			instancesToDestroy.pop_front();
+			DestroyObject(object);
 		}
 	}
-	void ObjectManager::DestroyType(vk::SurfaceKHR)
+	void ObjectManager::DestroyObject(const ManagedObject& object)
 	{
-		while (!surfacesToDestroy.empty())
+		switch (object.type)
+		{
+		case ObjectType::Semaphore:
+			GetDevice().destroySemaphore((VkSemaphore)object.handle);
+			break;
+		case ObjectType::Fence:
+			GetDevice().destroyFence((VkFence)object.handle);
+			break;
+		case ObjectType::CommandPool:
+			GetDevice().destroyCommandPool((VkCommandPool)object.handle);
+			break;
+		case ObjectType::Framebuffer:
+			GetDevice().destroyFramebuffer((VkFramebuffer)object.handle);
+			break;
+		case ObjectType::RenderPass:
+			GetDevice().destroyRenderPass((VkRenderPass)object.handle);
+			break;
+		case ObjectType::ShaderModule:
+			GetDevice().destroyShaderModule((VkShaderModule)object.handle);
+			break;
+		case ObjectType::Pipeline:
+			GetDevice().destroyPipeline((VkPipeline)object.handle);
+			break;
+		case ObjectType::PipelineCache:
+			GetDevice().destroyPipelineCache((VkPipelineCache)object.handle);
+			break;
+		case ObjectType::PipelineLayout:
+			GetDevice().destroyPipelineLayout((VkPipelineLayout)object.handle);
+			break;
+		case ObjectType::Buffer:
+			GetDevice().destroyBuffer((VkBuffer)object.handle);
+			break;
+		case ObjectType::DeviceMemory:
+			GetDevice().freeMemory((VkDeviceMemory)object.handle);
+			break;
+		case ObjectType::DescriptorPool:
+			GetDevice().destroyDescriptorPool((VkDescriptorPool)object.handle);
+			break;
+		case ObjectType::DescriptorUpdateTemplate:
+			GetDevice().destroyDescriptorUpdateTemplate((VkDescriptorUpdateTemplate)object.handle);
+			break;
+		case ObjectType::DescriptorSetLayout:
+			GetDevice().destroyDescriptorSetLayout((VkDescriptorSetLayout)object.handle);
+			break;
+		case ObjectType::Sampler:
+			GetDevice().destroySampler((VkSampler)object.handle);
+			break;
+		case ObjectType::QueryPool:
+			GetDevice().destroyQueryPool((VkQueryPool)object.handle);
+			break;
+		case ObjectType::Image:
+			GetDevice().destroyImage((VkImage)object.handle);
+			break;
+		case ObjectType::ImageView:
+			GetDevice().destroyImageView((VkImageView)object.handle);
+			break;
+		case ObjectType::VmaBuffer:
+			vmaDestroyBuffer(GetAllocator(), (VkBuffer)object.handle, object.allocation);
+			break;
+		case ObjectType::VmaImage:
+			vmaDestroyImage(GetAllocator(), (VkImage)object.handle, object.allocation);
+			break;
+		case ObjectType::VmaAllocator:
+			vmaDestroyAllocator((VmaAllocator)object.handle);
+			break;
+		case ObjectType::Swapchain:
+			GetDevice().destroySwapchainKHR((VkSwapchainKHR)object.handle);
+			break;
+		case ObjectType::Device:
 		{
-			instance.destroySurfaceKHR(surfacesToDestroy.front());
-			surfacesToDestroy.pop_front();
+			vk::Device managedDevice((VkDevice)object.handle);
+			managedDevice.waitIdle();
+			managedDevice.destroy();
+			break;
+		}
+		case ObjectType::Surface:
+			instance.destroySurfaceKHR((VkSurfaceKHR)object.handle);
+			break;
+		case ObjectType::Instance:
+			vk::Instance((VkInstance)object.handle).destroy();
+			break;
+		default:
+			assert(false);
 		}
 	}
-	void ObjectManager::DestroyType(vk::SwapchainKHR)
+	void ObjectManager::DestroyType(ObjectType type)
 	{
-		while (!swapchainsToDestroy.empty())
+		std::vector<ManagedObject> taken;
+		TakeObjects([type](const ManagedObject& object) { return object.type == type; }, taken);
+		for (auto& object : taken)
 		{
-			GetDevice().destroySwapchainKHR(swapchainsToDestroy.front());
-			swapchainsToDestroy.pop_front();
+			DestroyObject(object);
 		}
 	}
-	void ObjectManager::DestroyType(vk::Image)
+	void ObjectManager::SetTag(uint32_t tag)
+	{
+		currentTag.store(tag, std::memory_order_relaxed);
+	}
+	uint32_t ObjectManager::GetTag()
 	{
-		while (!imagesToDestroy.empty())
+		return currentTag.load(std::memory_order_relaxed);
+	}
+	void ObjectManager::DestroyTag(uint32_t tag)
+	{
+		std::vector<ManagedObject> taken;
+		TakeObjects([tag](const ManagedObject& object) { return object.tag == tag; }, taken);
+		std::stable_sort(taken.begin(), taken.end(), [](const ManagedObject& a, const ManagedObject& b) { return a.type < b.type; });
+		for (auto& object : taken)
 		{
-			GetDevice().destroyImage(imagesToDestroy.front());
-			imagesToDestroy.pop_front();
+			DestroyObject(object);
 		}
 	}
-	void ObjectManager::DestroyType(vk::ImageView)
+	uint64_t ObjectManager::ManagedCount()
 	{
-		while (!imageViewsToDestroy.empty())
+		uint64_t count = 0;
+		for (auto& shard : shards)
 		{
-			GetDevice().destroyImageView(imageViewsToDestroy.front());
-			imageViewsToDestroy.pop_front();
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			count += shard.objects.size();
 		}
+		return count;
 	}
-	void ObjectManager::DestroyType(VmaAllocator)
-	{
 
-		while (!allocatorsToDestroy.empty())
+
+	void ObjectManager::DestroyAll()
+	{
+		std::vector<RetiredObjects> retired;
+		{
+			std::lock_guard<std::mutex> lock(retiredMutex);
+			retired.swap(retiredObjects);
+		}
+		retired.clear();
+		std::vector<ManagedObject> taken;
+		TakeObjects([](const ManagedObject& object) { return true; }, taken);
+		std::stable_sort(taken.begin(), taken.end(), [](const ManagedObject& a, const ManagedObject& b) { return a.type < b.type; });
+		for (auto& object : taken)
 		{
-			vmaDestroyAllocator(allocatorsToDestroy.front());
-			allocatorsToDestroy.pop_front();
+			DestroyObject(object);
 		}
 	}
-	void ObjectManager::DestroyType(VmaBuffer)
+	void ObjectManager::RetireAll(vk::Semaphore semaphore, uint64_t value)
 	{
-		while (!vmaBuffersToDestroy.empty())
+		CollectRetired();
+		std::vector<ManagedObject> taken;
+		TakeObjects([](const ManagedObject& object)
+			{
+				return object.type != ObjectType::Device && object.type != ObjectType::Instance && object.type != ObjectType::Surface;
+			}, taken);
+		std::lock_guard<std::mutex> lock(retiredMutex);
+		auto& retired = GetRetiredObjects(semaphore, value);
+		for (auto& object : taken)
 		{
-			vmaDestroyBuffer(GetAllocator(), vmaBuffersToDestroy.front().buffer, vmaBuffersToDestroy.front().allocation);
-			vmaBuffersToDestroy.pop_front();
+			retired.Register(object);
 		}
 	}
-	void ObjectManager::DestroyType(VmaImage)
+	void ObjectManager::CollectRetired(bool wait)
 	{
-		while (!vmaImagesToDestroy.empty())
+		//Finished groups are released after the lock so their objects are not destroyed while other threads wait to retire
+		std::vector<RetiredObjects> finished;
 		{
-			vmaDestroyImage(GetAllocator(), vmaImagesToDestroy.back().image, vmaImagesToDestroy.back().allocation);
-			vmaImagesToDestroy.pop_back();
+			std::lock_guard<std::mutex> lock(retiredMutex);
+			for (uint64_t i = 0; i < retiredObjects.size();)
+			{
+				auto& retired = retiredObjects[i];
+				bool reached = false;
+				if (wait)
+				{
+					vk::SemaphoreWaitInfo waitInfo({}, 1, &retired.semaphore, &retired.value);
+					reached = GetDevice().waitSemaphores(waitInfo, UINT64_MAX) == vk::Result::eSuccess;
+				}
+				else
+				{
+					reached = GetDevice().getSemaphoreCounterValue(retired.semaphore) >= retired.value;
+				}
+				if (reached)
+				{
+					finished.emplace_back(std::move(retired));
+					retiredObjects.erase(retiredObjects.begin() + i);
+				}
+				else
+				{
+					i++;
+				}
+			}
 		}
 	}
-	void ObjectManager::DestroyType(vk::Sampler)
+	uint64_t ObjectManager::RetiredCount()
+	{
+		std::lock_guard<std::mutex> lock(retiredMutex);
+		return retiredObjects.size();
+	}
+	ObjectManager& ObjectManager::GetRetiredObjects(vk::Semaphore semaphore, uint64_t value)
 	{
-		while (!samplersToDestroy.empty())
+		assert(semaphore != NULL);
+		for (auto& retired : retiredObjects)
 		{
-			GetDevice().destroySampler(samplersToDestroy.back());
-			samplersToDestroy.pop_back();
+			if (retired.semaphore == semaphore && retired.value == value)
+			{
+				return *retired.objects;
+			}
 		}
+		retiredObjects.emplace_back(RetiredObjects{ semaphore, value, std::make_unique<ObjectManager>(*this) });
+		retiredObjects.back().objects->allocator = allocator;
+		return *retiredObjects.back().objects;
 	}
-
-
-	void ObjectManager::DestroyAll()
+	void ObjectManager::RetireObject(ManagedObject object, vk::Semaphore semaphore, uint64_t value)
 	{
-		DestroyType(vk::Semaphore());
-		DestroyType(vk::Fence());
-		DestroyType(vk::CommandPool());
-		DestroyType(vk::Framebuffer());
-		DestroyType(vk::RenderPass());
-		DestroyType(vk::ShaderModule());
-		DestroyType(vk::Pipeline());
-		DestroyType(vk::PipelineLayout());
-		DestroyType(vk::Buffer());
-		DestroyType(vk::DeviceMemory());
-		DestroyType(vk::DescriptorPool());
-		DestroyType(vk::DescriptorSetLayout());
-		DestroyType(vk::Sampler());
-		DestroyType(vk::Image());
-		DestroyType(vk::ImageView());
-		DestroyType(VmaBuffer());
-		DestroyType(VmaImage());
-		DestroyType(VmaAllocator());
-		DestroyType(vk::SwapchainKHR());
-		DestroyType(vk::Device());
-		DestroyType(vk::SurfaceKHR());
-		DestroyType(vk::Instance());
+		std::lock_guard<std::mutex> lock(retiredMutex);
+		GetRetiredObjects(semaphore, value).Register(object);
 	}
+
 	ObjectManager::~ObjectManager()
 	{
+		//Caches that are only held by this vom have to release their objects before a managed device goes
+		shaderCache = nullptr;
+		pipelineCache = nullptr;
+		objectCache = nullptr;
 		DestroyAll();
 	}
 
@@ -991,7 +1274,7 @@ namespace vkt
 
 
 
-	SemaphoreDataEntity::SemaphoreDataEntity(uint64_t _index, vk::Semaphore& semaphorePtr, std::shared_ptr<uint64_t>& signalValuePtr, vk::PipelineStageFlags& waitStagePtr)
+	SemaphoreDataEntity::SemaphoreDataEntity(uint64_t _index, vk::Semaphore& semaphorePtr, std::shared_ptr<uint64_t>& signalValuePtr, vk::PipelineStageFlags2& waitStagePtr)
 		: semaphore(semaphorePtr), signalValue(signalValuePtr), waitStage(waitStagePtr), index(_index)
 	{
 	}
@@ -1010,35 +1293,10 @@ namespace vkt
 	{
 		return SemaphoreDataEntity(index, semaphores[index], timelineValues[index], waitStages[index]);
 	}
-	SemaphoreDataEntity SemaphoreData::EmplaceBack(vk::Semaphore semaphore, std::shared_ptr<uint64_t> signalValue, vk::PipelineStageFlags waitStage)
+	SemaphoreDataEntity SemaphoreData::EmplaceBack(vk::Semaphore semaphore, std::shared_ptr<uint64_t> signalValue, vk::PipelineStageFlags2 waitStage)
 	{
-		if (signalValue == nullptr)
-		{
-			semaphores.emplace_back(semaphore);
-			timelineValues.emplace_back(signalValue);
-			waitStages.emplace_back(waitStage);
-			return SemaphoreDataEntity(semaphores.size(), semaphores.back(), timelineValues.back(), waitStages.back());
-
-		}
-		else
-		{
-			timelineCount++;
-			for (size_t i = 0; i < timelineValues.size(); i++)
-			{
-				if (timelineValues[i] == nullptr)
-				{
-					semaphores.emplace(semaphores.begin() + i, semaphore);
-					timelineValues.emplace(timelineValues.begin() + i, signalValue);
-					waitStages.emplace(waitStages.begin() + i, waitStage);
-					return SemaphoreDataEntity(i, semaphores[i], timelineValues[i], waitStages[i]);
-
-				}
-			}
-			semaphores.emplace_back(semaphore);
-			timelineValues.emplace_back(signalValue);
-			waitStages.emplace_back(waitStage);
-			return SemaphoreDataEntity(semaphores.size(), semaphores.back(), timelineValues.back(), waitStages.back());
-		}
+		bool timeline = signalValue != nullptr;
+		return Insert(semaphore, std::move(signalValue), 0, timeline, waitStage);
 	}
 	std::vector<SemaphoreDataEntity> SemaphoreData::EmplaceBack(std::vector<WaitData> datas)
 	{
@@ -1050,6 +1308,22 @@ namespace vkt
 		}
 		return createdEntities;
 	}
+	SemaphoreDataEntity SemaphoreData::EmplaceValue(SemaphoreWait wait)
+	{
+		return Insert(wait.semaphore, nullptr, wait.value, true, wait.stage);
+	}
+	uint64_t SemaphoreData::GetValue(uint64_t index)
+	{
+		if (!isTimeline[index])
+		{
+			return 0;
+		}
+		if (timelineValues[index] == nullptr)
+		{
+			return fixedValues[index];
+		}
+		return std::atomic_ref<uint64_t>(*timelineValues[index]).load(std::memory_order_acquire);
+	}
 	uint64_t SemaphoreData::size()
 	{
 		return semaphores.size();
@@ -1057,31 +1331,79 @@ namespace vkt
 	void SemaphoreData::ExtractTimelineValues()
 	{
 		extractedTimelineValues.clear();
-		for (size_t i = 0; i < timelineValues.size(); i++)
+		for (size_t i = 0; i < semaphores.size(); i++)
 		{
-			if (timelineValues[i] != nullptr)
+			if (isTimeline[i])
 			{
-				extractedTimelineValues.emplace_back(*timelineValues[i]);
+				extractedTimelineValues.emplace_back(GetValue(i));
 			}
 		}
 	}
 	uint32_t SemaphoreData::GetTimelineCount()
 	{
-		uint32_t count;
-		for (size_t i = 0; i < timelineValues.size(); i++)
+		uint32_t count = 0;
+		for (size_t i = 0; i < semaphores.size(); i++)
 		{
-			if (timelineValues[i] != nullptr)
+			if (isTimeline[i])
 			{
 				count++;
 			}
 		}
 		return count;
 	}
+	void SemaphoreData::Clear()
+	{
+		timelineCount = 0;
+		semaphores.clear();
+		timelineValues.clear();
+		fixedValues.clear();
+		isTimeline.clear();
+		waitStages.clear();
+		extractedTimelineValues.clear();
+	}
+	SemaphoreDataEntity SemaphoreData::Insert(vk::Semaphore semaphore, std::shared_ptr<uint64_t> signalValue, uint64_t fixedValue, bool timeline, vk::PipelineStageFlags2 waitStage)
+	{
+		//Timeline semaphores are kept in front of the normal ones
+		size_t index = semaphores.size();
+		if (timeline)
+		{
+			timelineCount++;
+			for (size_t i = 0; i < semaphores.size(); i++)
+			{
+				if (!isTimeline[i])
+				{
+					index = i;
+					break;
+				}
+			}
+		}
+		semaphores.insert(index, semaphore);
+		timelineValues.insert(index, std::move(signalValue));
+		fixedValues.insert(index, fixedValue);
+		isTimeline.insert(index, timeline);
+		waitStages.insert(index, waitStage);
+		return SemaphoreDataEntity(index, semaphores[index], timelineValues[index], waitStages[index]);
+	}
 
 
-	void SyncManager::AttachWaitData(std::vector<WaitData> datas)
+	void SyncManager::AttachWaitData(const std::vector<WaitData>& datas)
+	{
+		for (auto& data : datas)
+		{
+			AttachWaitData(data);
+		}
+	}
+	void SyncManager::AttachWaitData(const WaitData& data)
+	{
+		waitSemaphores.EmplaceBack(data.waitSemaphore, data.waitValuePtr, data.waitStage);
+	}
+	void SyncManager::AttachWait(SemaphoreWait wait)
+	{
+		waitSemaphores.EmplaceValue(wait);
+	}
+	void SyncManager::AttachNextWait(SemaphoreWait wait)
 	{
-		waitSemaphores.EmplaceBack(datas);
+		MergeWait(nextWaits, wait);
 	}
 	void SyncManager::CreateTimelineSignalSemaphore(uint64_t startValue)
 	{
@@ -1095,36 +1417,48 @@ namespace vkt
 	{
 		signalSemaphores.EmplaceBack(vom.MakeSemaphore(), {}, {});
 	}
-	vk::TimelineSemaphoreSubmitInfo SyncManager::GetTimelineSubmitInfo(bool withNormalWaits, bool withNormalSignals)
+	void SyncManager::GetWaitSubmitInfos(InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores>& infos, bool withNormalWaits)
 	{
-		waitSemaphores.ExtractTimelineValues();
-		signalSemaphores.ExtractTimelineValues();
-		timelineSubmitInfo = vk::TimelineSemaphoreSubmitInfo(
-			(withNormalWaits && waitSemaphores.timelineCount > 0) ? waitSemaphores.size() : waitSemaphores.timelineCount,
-			waitSemaphores.extractedTimelineValues.data(),
-			(withNormalSignals) ? signalSemaphores.size() : signalSemaphores.timelineCount,
-			signalSemaphores.extractedTimelineValues.data());
-
-		return timelineSubmitInfo;
+		infos.clear();
+		for (size_t i = 0; i < waitSemaphores.size(); i++)
+		{
+			if (waitSemaphores.isTimeline[i] || withNormalWaits)
+			{
+				infos.emplace_back(waitSemaphores.semaphores[i], waitSemaphores.GetValue(i), waitSemaphores.waitStages[i]);
+			}
+		}
+		for (auto& wait : nextWaits)
+		{
+			infos.emplace_back(wait.semaphore, wait.value, wait.stage);
+		}
+		nextWaits.clear();
 	}
-	vk::TimelineSemaphoreSubmitInfo* SyncManager::GetTimelineSubmitInfoPtr(bool withNormalWaits, bool withNormalSignals)
+	void SyncManager::GetSignalSubmitInfos(InlineVector<vk::SemaphoreSubmitInfo, MaxSubmitSemaphores>& infos, bool withNormalSignals)
 	{
-		GetTimelineSubmitInfo(withNormalWaits, withNormalSignals);
-		return &timelineSubmitInfo;
+		infos.clear();
+		for (size_t i = 0; i < signalSemaphores.size(); i++)
+		{
+			if (signalSemaphores.isTimeline[i] || withNormalSignals)
+			{
+				infos.emplace_back(signalSemaphores.semaphores[i], signalSemaphores.GetValue(i), vk::PipelineStageFlagBits2::eAllCommands);
+			}
+		}
 	}
 	void SyncManager::Clear()
 	{
-		waitSemaphores = SemaphoreData();
-		signalSemaphores = SemaphoreData();
+		nextWaits.clear();
+		waitSemaphores.Clear();
+		signalSemaphores.Clear();
 		vom.DestroyType(vk::Semaphore());
 	}
 	void SyncManager::ClearWaits()
 	{
-		waitSemaphores = SemaphoreData();
+		nextWaits.clear();
+		waitSemaphores.Clear();
 	}
 	void SyncManager::ClearSignals()
 	{
-		signalSemaphores = SemaphoreData();
+		signalSemaphores.Clear();
 	}
 
 
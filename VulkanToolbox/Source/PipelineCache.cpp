@@ -0,0 +1,132 @@
+#include "../Headers/VulkanToolbox.hpp"
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace vkt
+{
+	//Writes the whole file and flushes it to the disk before closing, only a file that made it there completely may replace the old cache
+	static bool WriteFileDurably(const std::string& filePath, const void* data, size_t size)
+	{
+	#ifdef _WIN32
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		bool written = true;
+		auto bytes = static_cast<const uint8_t*>(data);
+		while (written && size > 0)
+		{
+			DWORD chunk = static_cast<DWORD>((std::min)(size, size_t(1) << 30));
+			DWORD writtenBytes = 0;
+			written = WriteFile(file, bytes, chunk, &writtenBytes, nullptr) && writtenBytes > 0;
+			bytes += writtenBytes;
+			size -= writtenBytes;
+		}
+		written = written && FlushFileBuffers(file);
+		return CloseHandle(file) && written;
+	#else
+		int file = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (file < 0)
+		{
+			return false;
+		}
+		bool written = true;
+		auto bytes = static_cast<const uint8_t*>(data);
+		while (written && size > 0)
+		{
+			ssize_t writtenBytes = write(file, bytes, size);
+			if (writtenBytes < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			written = writtenBytes > 0;
+			if (written)
+			{
+				bytes += writtenBytes;
+				size -= static_cast<size_t>(writtenBytes);
+			}
+		}
+		written = written && fsync(file) == 0;
+		return close(file) == 0 && written;
+	#endif
+	}
+
+	//The cache vom is made from the device alone so it does not hold on to the cache itself
+	PersistentPipelineCache::PersistentPipelineCache(ObjectManager& _vom, std::string _path)
+		: vom(_vom.GetDevice()), properties(_vom.GetPhysicalDevice().getProperties()), path(std::move(_path))
+	{
+		MappedFile file(path.c_str());
+		vk::PipelineCacheCreateInfo createInfo;
+		if (file.IsOpen() && Validate(file.Data(), file.Size()))
+		{
+			createInfo.initialDataSize = file.Size();
+			createInfo.pInitialData = file.Data();
+			loaded = true;
+		}
+		cache = vom.MakePipelineCache(createInfo);
+	}
+	PersistentPipelineCache::~PersistentPipelineCache()
+	{
+		Save();
+	}
+
+	vk::PipelineCache PersistentPipelineCache::GetCache()
+	{
+		return cache;
+	}
+	bool PersistentPipelineCache::Save()
+	{
+		auto data = vom.GetDevice().getPipelineCacheData(cache);
+		std::string temporaryPath = path + ".tmp";
+		std::error_code error;
+		if (!WriteFileDurably(temporaryPath, data.data(), data.size()))
+		{
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+		std::filesystem::rename(temporaryPath, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporaryPath, error);
+			return false;
+		}
+		return true;
+	}
+	bool PersistentPipelineCache::LoadedFromDisk()
+	{
+		return loaded;
+	}
+
+	bool PersistentPipelineCache::Validate(const uint8_t* data, size_t size)
+	{
+		//Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE: header size, header version, vendor id, device id and the cache uuid
+		constexpr size_t headerSize = sizeof(uint32_t) * 4 + VK_UUID_SIZE;
+		if (size < headerSize)
+		{
+			return false;
+		}
+		uint32_t header[4];
+		memcpy(header, data, sizeof(header));
+		if (header[0] < headerSize || header[0] > size || header[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+		{
+			return false;
+		}
+		if (header[2] != properties.vendorID || header[3] != properties.deviceID)
+		{
+			return false;
+		}
+		return memcmp(data + sizeof(header), properties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+	}
+}
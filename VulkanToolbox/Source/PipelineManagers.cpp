@@ -2,6 +2,24 @@
 
 namespace vkt
 {
+		/**
+		 * \brief A pipeline layout create info with copies of the arrays it points at, for builds that run after the caller returned
+		 */
+		struct PipelineLayoutData
+		{
+			PipelineLayoutData(vk::PipelineLayoutCreateInfo _createInfo)
+				: createInfo(_createInfo),
+				setLayouts(_createInfo.pSetLayouts, _createInfo.pSetLayouts + _createInfo.setLayoutCount),
+				pushConstantRanges(_createInfo.pPushConstantRanges, _createInfo.pPushConstantRanges + _createInfo.pushConstantRangeCount)
+			{
+				createInfo.pSetLayouts = setLayouts.data();
+				createInfo.pPushConstantRanges = pushConstantRanges.data();
+			}
+
+			vk::PipelineLayoutCreateInfo createInfo;
+			std::vector<vk::DescriptorSetLayout> setLayouts;
+			std::vector<vk::PushConstantRange> pushConstantRanges;
+		};
 
 		ComputePipelineManager::ComputePipelineManager(ObjectManager& _vom, vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo, const char* shaderPath)
 			: vom(_vom)
@@ -11,7 +29,8 @@ namespace vkt
 			vk::PipelineShaderStageCreateInfo computeStage({}, vk::ShaderStageFlagBits::eCompute, compiledShader, "main");
 			vk::ComputePipelineCreateInfo computePipelineCreateInfo({}, computeStage, layout);
 			computePipeline = vom.MakePipeline({}, computePipelineCreateInfo);
-			vom.DestroyType(vk::ShaderModule());
+			//Only the module of this pipeline is destroyed, other modules of the vom stay alive
+			vom.Destroy(compiledShader);
 		}
 		ComputePipelineManager::ComputePipelineManager(vk::Device deviceHandle, vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo, const char* shaderPath)
 			: vom(deviceHandle)
@@ -21,7 +40,17 @@ namespace vkt
 			vk::PipelineShaderStageCreateInfo computeStage({}, vk::ShaderStageFlagBits::eCompute, compiledShader, "main");
 			vk::ComputePipelineCreateInfo computePipelineCreateInfo({}, computeStage, layout);
 			computePipeline = vom.MakePipeline({}, computePipelineCreateInfo);
-			vom.DestroyType(vk::ShaderModule());
+			vom.Destroy(compiledShader);
+		}
+		AsyncPipeline<ComputePipelineManager> ComputePipelineManager::BuildAsync(JobSystem& jobs, ObjectManager& _vom, vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo, std::string shaderPath, std::vector<JobHandle> dependencies)
+		{
+			auto layoutData = std::make_shared<PipelineLayoutData>(pipelineLayoutCreateInfo);
+			auto result = std::make_shared<std::unique_ptr<ComputePipelineManager>>();
+			auto job = jobs.Schedule([&_vom, layoutData, shaderPath, result]()
+				{
+					*result = std::make_unique<ComputePipelineManager>(_vom, layoutData->createInfo, shaderPath.c_str());
+				}, std::move(dependencies));
+			return AsyncPipeline<ComputePipelineManager>(jobs, job, result);
 		}
 
 
@@ -135,7 +164,35 @@ namespace vkt
 				renderPass, 0);
 			pipeline = vom.MakePipeline({}, state.graphicsPipelineCreateInfo);
 		}
-
-
+		AsyncPipeline<GraphicsPipelineManager> GraphicsPipelineManager::BuildAsync(JobSystem& jobs, ObjectManager& _vom,
+			vk::RenderPass _renderPass,
+			std::vector<std::string> shaderPaths,
+			std::vector<vk::ShaderStageFlagBits> shaderStageFlagBits,
+			std::vector<vk::VertexInputBindingDescription> vertexBindings, std::vector<vk::VertexInputAttributeDescription> vertexAttributes,
+			vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState,
+			vk::Viewport viewport, vk::Rect2D scissor,
+			vk::PipelineRasterizationStateCreateInfo rasterizationState,
+			vk::PipelineMultisampleStateCreateInfo multisampleState,
+			vk::PipelineDepthStencilStateCreateInfo depthStencilState,
+			std::vector<vk::PipelineColorBlendAttachmentState> colorBlendAttachments,
+			vk::PipelineColorBlendStateCreateInfo colorBlendState,
+			vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo,
+			std::vector<JobHandle> dependencies)
+		{
+			auto layoutData = std::make_shared<PipelineLayoutData>(pipelineLayoutCreateInfo);
+			auto result = std::make_shared<std::unique_ptr<GraphicsPipelineManager>>();
+			auto job = jobs.Schedule([=, &_vom]()
+				{
+					std::vector<const char*> paths;
+					for (auto& path : shaderPaths)
+					{
+						paths.emplace_back(path.c_str());
+					}
+					*result = std::make_unique<GraphicsPipelineManager>(_vom, _renderPass, paths, shaderStageFlagBits, vertexBindings, vertexAttributes,
+						inputAssemblyState, viewport, scissor, rasterizationState, multisampleState, depthStencilState, colorBlendAttachments, colorBlendState,
+						layoutData->createInfo);
+				}, std::move(dependencies));
+			return AsyncPipeline<GraphicsPipelineManager>(jobs, job, result);
+		}
 
 }
@@ -0,0 +1,160 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	PipelineStatisticsProfiler::PipelineStatisticsProfiler(ObjectManager& _vom, vk::Semaphore _timeline, vk::QueryPipelineStatisticFlags _statistics, uint32_t _maxZones, uint32_t framesInFlight)
+	{
+		assert(_timeline != NULL);
+		assert(_statistics);
+		assert(_maxZones > 0 && framesInFlight > 0);
+		device = _vom.GetDevice();
+		timeline = _timeline;
+		statistics = _statistics;
+		statisticCount = std::popcount(static_cast<VkQueryPipelineStatisticFlags>(statistics));
+		maxZones = _maxZones;
+		frames.resize(framesInFlight);
+		results.resize(maxZones * statisticCount);
+		queryPool = _vom.MakeQueryPool(vk::QueryPoolCreateInfo({}, vk::QueryType::ePipelineStatistics, maxZones * framesInFlight, statistics));
+	}
+	bool PipelineStatisticsProfiler::Enabled()
+	{
+		return queryPool != NULL;
+	}
+	void PipelineStatisticsProfiler::BeginZone(vk::CommandBuffer cmd, std::string name, uint64_t objectCount)
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		assert(!zoneOpen);
+		zoneOpen = true;
+		auto& frame = frames[currentFrame];
+		if (frame.pending)
+		{
+			vk::SemaphoreWaitInfo waitInfo({}, 1, &timeline, &frame.submitValue);
+			auto res = device.waitSemaphores(waitInfo, UINT64_MAX);
+			ResolveFrame(frame, currentFrame);
+		}
+		zoneSkipped = frame.zones.size() >= maxZones;
+		if (zoneSkipped)
+		{
+			return;
+		}
+		uint32_t base = currentFrame * maxZones;
+		if (frame.zones.empty())
+		{
+			cmd.resetQueryPool(queryPool, base, maxZones);
+		}
+		frame.zones.emplace_back(PipelineStatisticsZone{ name, uint32_t(frame.zones.size()), objectCount });
+		cmd.beginQuery(queryPool, base + frame.zones.back().query, {});
+	}
+	void PipelineStatisticsProfiler::EndZone(vk::CommandBuffer cmd)
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		assert(zoneOpen);
+		zoneOpen = false;
+		if (zoneSkipped)
+		{
+			return;
+		}
+		cmd.endQuery(queryPool, currentFrame * maxZones + frames[currentFrame].zones.back().query);
+	}
+	void PipelineStatisticsProfiler::EndFrame(uint64_t submitValue)
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		assert(!zoneOpen);
+		auto& frame = frames[currentFrame];
+		if (frame.zones.empty())
+		{
+			return;
+		}
+		frame.submitValue = submitValue;
+		frame.pending = true;
+		currentFrame = (currentFrame + 1) % frames.size();
+	}
+	void PipelineStatisticsProfiler::Resolve()
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		uint64_t reached = device.getSemaphoreCounterValue(timeline);
+		for (uint32_t i = 0; i < frames.size(); i++)
+		{
+			if (frames[i].pending && frames[i].submitValue <= reached)
+			{
+				ResolveFrame(frames[i], i);
+			}
+		}
+	}
+	std::vector<PipelineStatisticsReport> PipelineStatisticsProfiler::GetReports()
+	{
+		return reports;
+	}
+
+	void PipelineStatisticsProfiler::ResolveFrame(PipelineStatisticsFrame& frame, uint32_t frameIndex)
+	{
+		uint64_t stride = statisticCount * sizeof(uint64_t);
+		auto res = device.getQueryPoolResults(queryPool, frameIndex * maxZones, frame.zones.size(), frame.zones.size() * stride, results.data(), stride, vk::QueryResultFlagBits::e64);
+		if (res == vk::Result::eSuccess)
+		{
+			for (auto& zone : frame.zones)
+			{
+				auto found = std::find_if(reports.begin(), reports.end(), [&](PipelineStatisticsReport& report) { return report.name == zone.name; });
+				if (found == reports.end())
+				{
+					reports.emplace_back();
+					reports.back().name = zone.name;
+					found = reports.end() - 1;
+				}
+
+				//Results are written in the bit order of the enabled statistics
+				uint64_t* values = results.data() + zone.query * statisticCount;
+				uint32_t valueIndex = 0;
+				VkQueryPipelineStatisticFlags bits = static_cast<VkQueryPipelineStatisticFlags>(statistics);
+				for (uint32_t bit = 0; bit < 32; bit++)
+				{
+					auto flag = vk::QueryPipelineStatisticFlagBits(1u << bit);
+					if (!(bits & (1u << bit)))
+					{
+						continue;
+					}
+					uint64_t value = values[valueIndex++];
+					switch (flag)
+					{
+					case vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations:
+						found->vertexInvocations = value;
+						break;
+					case vk::QueryPipelineStatisticFlagBits::eClippingPrimitives:
+						found->clippingPrimitives = value;
+						break;
+					case vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations:
+						found->fragmentInvocations = value;
+						break;
+					case vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations:
+						found->computeInvocations = value;
+						break;
+					default:
+						break;
+					}
+				}
+
+				double objects = double((std::max)(zone.objectCount, uint64_t(1)));
+				found->objectCount = zone.objectCount;
+				found->vertexInvocationsPerObject = found->vertexInvocations / objects;
+				found->clippingPrimitivesPerObject = found->clippingPrimitives / objects;
+				found->fragmentInvocationsPerObject = found->fragmentInvocations / objects;
+				found->computeInvocationsPerObject = found->computeInvocations / objects;
+				found->excessComputeInvocations = (found->computeInvocations > zone.objectCount) ? found->computeInvocations - zone.objectCount : 0;
+			}
+		}
+		frame.zones.clear();
+		frame.pending = false;
+	}
+}
@@ -0,0 +1,254 @@
+#include "../Headers/VulkanToolbox.hpp"
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace vkt
+{
+	uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+
+
+	MappedFile::MappedFile(const char* path)
+	{
+	#ifdef _WIN32
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return;
+		}
+		fileHandle = file;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			return;
+		}
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr)
+		{
+			return;
+		}
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		size = (data != nullptr) ? static_cast<size_t>(fileSize.QuadPart) : 0;
+	#else
+		fileDescriptor = open(path, O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			return;
+		}
+		struct stat fileStat;
+		if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			return;
+		}
+		void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mapped == MAP_FAILED)
+		{
+			return;
+		}
+		data = static_cast<const uint8_t*>(mapped);
+		size = static_cast<size_t>(fileStat.st_size);
+	#endif
+	}
+	MappedFile::~MappedFile()
+	{
+	#ifdef _WIN32
+		if (data != nullptr)
+		{
+			UnmapViewOfFile(data);
+		}
+		if (mappingHandle != nullptr)
+		{
+			CloseHandle(mappingHandle);
+		}
+		if (fileHandle != nullptr)
+		{
+			CloseHandle(fileHandle);
+		}
+	#else
+		if (data != nullptr)
+		{
+			munmap(const_cast<uint8_t*>(data), size);
+		}
+		if (fileDescriptor >= 0)
+		{
+			close(fileDescriptor);
+		}
+	#endif
+	}
+	bool MappedFile::IsOpen()
+	{
+		return data != nullptr;
+	}
+	const uint8_t* MappedFile::Data()
+	{
+		return data;
+	}
+	size_t MappedFile::Size()
+	{
+		return size;
+	}
+
+
+
+	//The cache vom is made from the device alone so it does not hold on to a cache itself
+	ShaderCache::ShaderCache(ObjectManager& _vom)
+		: vom(_vom.GetDevice())
+	{
+	}
+	ShaderCache::ShaderCache(vk::Device deviceHandle)
+		: vom(deviceHandle)
+	{
+	}
+
+	vk::ShaderModule ShaderCache::Get(const char* shaderPath)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return Load(shaderPath, false);
+	}
+	vk::ShaderModule ShaderCache::Get(const uint32_t* code, size_t codeSize)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		//Modules made from memory are not tied to a file, so they stay until the cache is cleared
+		return modules[Acquire(code, codeSize)].module;
+	}
+	void ShaderCache::SetWatching(bool watch)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		watching = watch;
+	}
+	std::vector<std::string> ShaderCache::Poll()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::vector<std::string> changed;
+		for (auto& [path, file] : files)
+		{
+			std::error_code error;
+			auto writeTime = std::filesystem::last_write_time(path, error);
+			if (!error && writeTime != file.writeTime)
+			{
+				changed.emplace_back(path);
+			}
+		}
+		std::vector<std::string> replaced;
+		for (auto& path : changed)
+		{
+			uint64_t previousKey = files[path].moduleKey;
+			Load(path, true);
+			if (files[path].moduleKey != previousKey)
+			{
+				replaced.emplace_back(path);
+			}
+		}
+		return replaced;
+	}
+	void ShaderCache::Invalidate(const char* shaderPath)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = files.find(shaderPath);
+		if (found == files.end())
+		{
+			return;
+		}
+		ReleaseModule(found->second.moduleKey);
+		files.erase(found);
+	}
+	void ShaderCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		files.clear();
+		modules.clear();
+		vom.DestroyType(vk::ShaderModule());
+	}
+	uint64_t ShaderCache::ModuleCount()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return modules.size();
+	}
+
+	vk::ShaderModule ShaderCache::Load(const std::string& path, bool reload)
+	{
+		auto found = files.find(path);
+		if (found != files.end() && !reload)
+		{
+			std::error_code error;
+			if (!watching || std::filesystem::last_write_time(path, error) == found->second.writeTime || error)
+			{
+				return modules[found->second.moduleKey].module;
+			}
+		}
+
+		//A file that is still being written or is not SPIR-V leaves the old module in place, the write time is kept so the next Poll tries again
+		MappedFile file(path.c_str());
+		if (!file.IsOpen() || file.Size() % sizeof(uint32_t) != 0)
+		{
+			return found != files.end() ? modules[found->second.moduleKey].module : vk::ShaderModule();
+		}
+		std::error_code error;
+		auto writeTime = std::filesystem::last_write_time(path, error);
+		//The new module is acquired first so that contents shared with the old version are not destroyed in between
+		uint64_t key = Acquire(reinterpret_cast<const uint32_t*>(file.Data()), file.Size());
+		if (found != files.end())
+		{
+			found->second.writeTime = writeTime;
+			ReleaseModule(found->second.moduleKey);
+			found->second.moduleKey = key;
+			return modules[key].module;
+		}
+		files.emplace(path, CachedShaderFile{ key, writeTime });
+		return modules[key].module;
+	}
+	uint64_t ShaderCache::Acquire(const uint32_t* code, size_t codeSize)
+	{
+		uint64_t key = HashBytes(code, codeSize);
+		size_t wordCount = codeSize / sizeof(uint32_t);
+		while (true)
+		{
+			auto& cached = modules[key];
+			if (cached.module == VK_NULL_HANDLE)
+			{
+				cached.module = vom.GetDevice().createShaderModule(vk::ShaderModuleCreateInfo({}, codeSize, code));
+				cached.code.assign(code, code + wordCount);
+				vom.Manage(cached.module);
+			}
+			else if (cached.code.size() != wordCount || memcmp(cached.code.data(), code, codeSize) != 0)
+			{
+				key++;
+				continue;
+			}
+			cached.users++;
+			return key;
+		}
+	}
+	void ShaderCache::ReleaseModule(uint64_t key)
+	{
+		auto found = modules.find(key);
+		if (found == modules.end() || --found->second.users > 0)
+		{
+			return;
+		}
+		vom.Destroy(found->second.module);
+		modules.erase(found);
+	}
+}
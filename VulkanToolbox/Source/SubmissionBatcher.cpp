@@ -0,0 +1,84 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	void BatchedSubmit::Assign(std::span<const vk::SemaphoreSubmitInfo> _waits, std::span<const vk::CommandBufferSubmitInfo> _commandBuffers, std::span<const vk::SemaphoreSubmitInfo> _signals)
+	{
+		waits.assign(_waits);
+		commandBuffers.assign(_commandBuffers);
+		signals.assign(_signals);
+	}
+
+	void SubmissionBatcher::Add(QueueData queue, std::span<const vk::SemaphoreSubmitInfo> waits, std::span<const vk::CommandBufferSubmitInfo> commandBuffers, std::span<const vk::SemaphoreSubmitInfo> signals)
+	{
+		assert(queue.queue != NULL);
+		for (auto& batch : queueBatches)
+		{
+			if (batch.queue.queue == queue.queue)
+			{
+				batch.submits.emplace_back().Assign(waits, commandBuffers, signals);
+				return;
+			}
+		}
+		queueBatches.emplace_back();
+		queueBatches.back().queue = queue;
+		queueBatches.back().submits.emplace_back().Assign(waits, commandBuffers, signals);
+	}
+	void SubmissionBatcher::Flush(vk::Fence fence)
+	{
+		assert(fence == VK_NULL_HANDLE || QueueCount() <= 1);
+		for (auto& batch : queueBatches)
+		{
+			if (batch.submits.empty())
+			{
+				continue;
+			}
+			//The submit infos point into the batched submits which are no longer touched until the batcher is cleared
+			batch.submitInfos.clear();
+			for (auto& submit : batch.submits)
+			{
+				batch.submitInfos.emplace_back(vk::SubmitInfo2(
+					{},
+					submit.waits.size(),
+					submit.waits.data(),
+					submit.commandBuffers.size(),
+					submit.commandBuffers.data(),
+					submit.signals.size(),
+					submit.signals.data()));
+			}
+			std::lock_guard<std::mutex> lock(QueueMutex(batch.queue.queue));
+			auto res = batch.queue.queue.submit2(batch.submitInfos.size(), batch.submitInfos.data(), fence);
+		}
+		Clear();
+	}
+	void SubmissionBatcher::Clear()
+	{
+		//The batches keep the capacity of their vectors, so a steady stream of submissions stops allocating after the first flushes
+		for (auto& batch : queueBatches)
+		{
+			batch.submits.clear();
+		}
+	}
+	bool SubmissionBatcher::Empty()
+	{
+		return SubmitCount() == 0;
+	}
+	uint64_t SubmissionBatcher::QueueCount()
+	{
+		uint64_t count = 0;
+		for (auto& batch : queueBatches)
+		{
+			count += batch.submits.empty() ? 0 : 1;
+		}
+		return count;
+	}
+	uint64_t SubmissionBatcher::SubmitCount()
+	{
+		uint64_t count = 0;
+		for (auto& batch : queueBatches)
+		{
+			count += batch.submits.size();
+		}
+		return count;
+	}
+}
@@ -0,0 +1,162 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	SubmissionThread::SubmissionThread(ObjectManager& _vom, QueueData _queue)
+		: vom(_vom), queue(_queue)
+	{
+		Start();
+	}
+	SubmissionThread::SubmissionThread(vk::Device deviceHandle, QueueData _queue)
+		: vom(deviceHandle), queue(_queue)
+	{
+		Start();
+	}
+	SubmissionThread::~SubmissionThread()
+	{
+		Stop();
+	}
+
+	void SubmissionThread::Enqueue(std::span<const vk::SemaphoreSubmitInfo> waits, std::span<const vk::CommandBufferSubmitInfo> commandBuffers, std::span<const vk::SemaphoreSubmitInfo> signals, vk::Fence fence)
+	{
+		ThreadedSubmit threadedSubmit;
+		threadedSubmit.submit.Assign(waits, commandBuffers, signals);
+		threadedSubmit.fence = fence;
+		enqueued.fetch_add(1, std::memory_order_relaxed);
+		submissions.Push(std::move(threadedSubmit));
+		Notify();
+	}
+	void SubmissionThread::EnqueuePresent(vk::SwapchainKHR swapchain, uint32_t imageIndex, vk::Semaphore waitSemaphore)
+	{
+		assert(swapchain != NULL);
+		ThreadedSubmit threadedSubmit;
+		threadedSubmit.present = true;
+		threadedSubmit.swapchain = swapchain;
+		threadedSubmit.imageIndex = imageIndex;
+		threadedSubmit.presentWait = waitSemaphore;
+		enqueued.fetch_add(1, std::memory_order_relaxed);
+		submissions.Push(std::move(threadedSubmit));
+		Notify();
+	}
+	void SubmissionThread::Flush()
+	{
+		uint64_t target = enqueued.load(std::memory_order_acquire);
+		uint64_t current = submitted.load(std::memory_order_acquire);
+		while (current < target)
+		{
+			submitted.wait(current, std::memory_order_acquire);
+			current = submitted.load(std::memory_order_acquire);
+		}
+	}
+	void SubmissionThread::Stop()
+	{
+		if (!running.exchange(false))
+		{
+			return;
+		}
+		Notify();
+		worker.join();
+	}
+	uint64_t SubmissionThread::EnqueuedCount()
+	{
+		return enqueued.load(std::memory_order_acquire);
+	}
+	uint64_t SubmissionThread::SubmittedCount()
+	{
+		return submitted.load(std::memory_order_acquire);
+	}
+	QueueData SubmissionThread::GetQueue()
+	{
+		return queue;
+	}
+
+	void SubmissionThread::Start()
+	{
+		assert(queue.queue != NULL);
+		running = true;
+		worker = std::thread(&SubmissionThread::Run, this);
+	}
+	void SubmissionThread::Notify()
+	{
+		wakeCount.fetch_add(1, std::memory_order_release);
+		wakeCount.notify_one();
+	}
+	void SubmissionThread::Run()
+	{
+		//A batch never holds more than the queue's capacity, so it is sized once and never grows on this thread
+		std::vector<ThreadedSubmit> batch;
+		batch.reserve(QueueCapacity);
+		ThreadedSubmit next;
+		while (true)
+		{
+			//The wake count is read before draining, so a push that lands after the drain changes it and the wait returns right away
+			uint64_t observedWake = wakeCount.load(std::memory_order_acquire);
+			bool stopping = !running.load(std::memory_order_acquire);
+			while (batch.size() < QueueCapacity && submissions.TryPop(next))
+			{
+				batch.emplace_back(std::move(next));
+			}
+			if (!batch.empty())
+			{
+				Submit(batch);
+				continue;
+			}
+			if (stopping)
+			{
+				return;
+			}
+			wakeCount.wait(observedWake, std::memory_order_acquire);
+		}
+	}
+	void SubmissionThread::Submit(std::vector<ThreadedSubmit>& batch)
+	{
+		//Only the worker thread submits, so the submit infos are a member that keeps its capacity
+		submitInfos.clear();
+		uint64_t handled = 0;
+		auto submitPending = [&](vk::Fence fence)
+		{
+			if (!submitInfos.empty() || fence != VK_NULL_HANDLE)
+			{
+				std::lock_guard<std::mutex> lock(QueueMutex(queue.queue));
+				auto res = queue.queue.submit2(submitInfos.size(), submitInfos.data(), fence);
+			}
+			submitted.fetch_add(handled, std::memory_order_release);
+			submitted.notify_all();
+			submitInfos.clear();
+			handled = 0;
+		};
+
+		for (auto& entry : batch)
+		{
+			if (entry.present)
+			{
+				//Presents are ordered after the submissions before them, so those are flushed first
+				submitPending(VK_NULL_HANDLE);
+				vk::PresentInfoKHR presentInfo((entry.presentWait != VK_NULL_HANDLE) ? 1 : 0, &entry.presentWait, 1, &entry.swapchain, &entry.imageIndex);
+				{
+					std::lock_guard<std::mutex> lock(QueueMutex(queue.queue));
+					auto res = queue.queue.presentKHR(&presentInfo);
+				}
+				handled++;
+				submitPending(VK_NULL_HANDLE);
+				continue;
+			}
+			auto& submit = entry.submit;
+			submitInfos.emplace_back(vk::SubmitInfo2(
+				{},
+				submit.waits.size(),
+				submit.waits.data(),
+				submit.commandBuffers.size(),
+				submit.commandBuffers.data(),
+				submit.signals.size(),
+				submit.signals.data()));
+			handled++;
+			if (entry.fence != VK_NULL_HANDLE)
+			{
+				submitPending(entry.fence);
+			}
+		}
+		submitPending(VK_NULL_HANDLE);
+		batch.clear();
+	}
+}
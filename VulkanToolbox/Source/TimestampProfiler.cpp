@@ -0,0 +1,140 @@
+#include "../Headers/VulkanToolbox.hpp"
+
+namespace vkt
+{
+	TimestampProfiler::TimestampProfiler(ObjectManager& _vom, vk::Semaphore _timeline, float _timestampPeriod, uint32_t maxZones, uint32_t framesInFlight, uint32_t _historySize)
+	{
+		assert(_timeline != NULL);
+		assert(maxZones > 0 && framesInFlight > 0 && _historySize > 0);
+		device = _vom.GetDevice();
+		timeline = _timeline;
+		timestampPeriod = _timestampPeriod;
+		queriesPerFrame = maxZones * 2;
+		historySize = _historySize;
+		frames.resize(framesInFlight);
+		results.resize(queriesPerFrame);
+		queryPool = _vom.MakeQueryPool(vk::QueryPoolCreateInfo({}, vk::QueryType::eTimestamp, queriesPerFrame * framesInFlight));
+	}
+	bool TimestampProfiler::Enabled()
+	{
+		return queryPool != NULL;
+	}
+	void TimestampProfiler::BeginZone(vk::CommandBuffer cmd, std::string name)
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		auto& frame = frames[currentFrame];
+		if (frame.pending)
+		{
+			//The slot is still in use by an older submission, this only blocks when the gpu is more than framesInFlight submissions behind
+			vk::SemaphoreWaitInfo waitInfo({}, 1, &timeline, &frame.submitValue);
+			auto res = device.waitSemaphores(waitInfo, UINT64_MAX);
+			ResolveFrame(frame, currentFrame);
+		}
+		if (frame.usedQueries + 2 > queriesPerFrame)
+		{
+			openZones.emplace_back(UINT32_MAX);
+			return;
+		}
+		uint32_t base = currentFrame * queriesPerFrame;
+		if (frame.usedQueries == 0)
+		{
+			cmd.resetQueryPool(queryPool, base, queriesPerFrame);
+		}
+		frame.zones.emplace_back(TimestampZone{ name, frame.usedQueries, frame.usedQueries + 1 });
+		frame.usedQueries += 2;
+		openZones.emplace_back(frame.zones.size() - 1);
+		cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, queryPool, base + frame.zones.back().beginQuery);
+	}
+	void TimestampProfiler::EndZone(vk::CommandBuffer cmd)
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		assert(!openZones.empty());
+		uint32_t zone = openZones.back();
+		openZones.pop_back();
+		if (zone == UINT32_MAX)
+		{
+			return;
+		}
+		auto& frame = frames[currentFrame];
+		cmd.writeTimestamp2(vk::PipelineStageFlagBits2::eAllCommands, queryPool, currentFrame * queriesPerFrame + frame.zones[zone].endQuery);
+	}
+	void TimestampProfiler::EndFrame(uint64_t submitValue)
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		assert(openZones.empty());
+		auto& frame = frames[currentFrame];
+		if (frame.usedQueries == 0)
+		{
+			return;
+		}
+		frame.submitValue = submitValue;
+		frame.pending = true;
+		currentFrame = (currentFrame + 1) % frames.size();
+	}
+	void TimestampProfiler::Resolve()
+	{
+		if (!Enabled())
+		{
+			return;
+		}
+		uint64_t reached = device.getSemaphoreCounterValue(timeline);
+		for (uint32_t i = 0; i < frames.size(); i++)
+		{
+			if (frames[i].pending && frames[i].submitValue <= reached)
+			{
+				ResolveFrame(frames[i], i);
+			}
+		}
+	}
+	std::vector<ZoneStatistics> TimestampProfiler::GetStatistics()
+	{
+		return statistics;
+	}
+
+	void TimestampProfiler::ResolveFrame(ProfilerFrame& frame, uint32_t frameIndex)
+	{
+		auto res = device.getQueryPoolResults(queryPool, frameIndex * queriesPerFrame, frame.usedQueries, frame.usedQueries * sizeof(uint64_t), results.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+		if (res == vk::Result::eSuccess)
+		{
+			for (auto& zone : frame.zones)
+			{
+				double ms = double(results[zone.endQuery] - results[zone.beginQuery]) * timestampPeriod / 1000000.0;
+				auto found = std::find_if(statistics.begin(), statistics.end(), [&](ZoneStatistics& stats) { return stats.name == zone.name; });
+				if (found == statistics.end())
+				{
+					statistics.emplace_back();
+					statistics.back().name = zone.name;
+					found = statistics.end() - 1;
+				}
+				found->history.emplace_back(ms);
+				if (found->history.size() > historySize)
+				{
+					found->history.pop_front();
+				}
+				found->lastMs = ms;
+				found->minMs = ms;
+				found->maxMs = ms;
+				double sum = 0;
+				for (auto sample : found->history)
+				{
+					sum += sample;
+					found->minMs = (std::min)(found->minMs, sample);
+					found->maxMs = (std::max)(found->maxMs, sample);
+				}
+				found->averageMs = sum / found->history.size();
+			}
+		}
+		frame.zones.clear();
+		frame.usedQueries = 0;
+		frame.pending = false;
+	}
+}